@@ -0,0 +1,99 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#include "ConnectionTable.hpp"
+
+#include <poll.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+
+ConnectionTable::ConnectionTable(void): limit(0), used(0) { }
+
+ConnectionTable::ConnectionTable(const ConnectionTable&) { }
+
+ConnectionTable& ConnectionTable::operator=(const ConnectionTable&) {
+  return *this;
+}
+
+ConnectionTable::~ConnectionTable(void) { }
+
+// the table may grow up to the number of descriptors the process can open
+void ConnectionTable::init(size_t reserve) {
+  struct rlimit rl;
+
+  if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY)
+    limit = rl.rlim_cur;
+  else
+    limit = 1024;
+  reserve = std::min(reserve, limit);
+  fd.reserve(reserve);
+  events.reserve(reserve);
+  deadline.reserve(reserve);
+  state.reserve(reserve);
+  server.reserve(reserve);
+  parser.reserve(reserve);
+  response.reserve(reserve);
+}
+
+int ConnectionTable::insert(int _fd, Server* _server) {
+  int slot;
+
+  if (free_slots.size()) {
+    slot = free_slots.back();
+    free_slots.pop_back();
+  } else {
+    if (fd.size() >= limit)
+      return -1;
+    slot = fd.size();
+    fd.push_back(-1);
+    events.push_back(0);
+    deadline.push_back(0);
+    state.push_back(CONN_FREE);
+    server.push_back(NULL);
+    parser.push_back(NULL);
+    response.push_back(NULL);
+  }
+  if (_fd >= static_cast<int>(by_fd.size()))
+    by_fd.resize(_fd + 1, -1);
+  by_fd[_fd] = slot;
+  fd[slot] = _fd;
+  events[slot] = POLLIN;
+  deadline[slot] = 0;
+  state[slot] = CONN_READING;
+  server[slot] = _server;
+  parser[slot] = NULL;
+  response[slot] = NULL;
+  used++;
+  return slot;
+}
+
+void ConnectionTable::remove(int slot) {
+  by_fd[fd[slot]] = -1;
+  fd[slot] = -1;
+  events[slot] = 0;
+  state[slot] = CONN_FREE;
+  server[slot] = NULL;
+  parser[slot] = NULL;
+  response[slot] = NULL;
+  free_slots.push_back(slot);
+  used--;
+}
+
+int ConnectionTable::slot_of(int _fd) const {
+  if (_fd < 0 || _fd >= static_cast<int>(by_fd.size()))
+    return -1;
+  return by_fd[_fd];
+}
+
+size_t ConnectionTable::size(void) const {
+  return used;
+}
+
+size_t ConnectionTable::capacity(void) const {
+  return fd.size();
+}
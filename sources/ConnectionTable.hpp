@@ -0,0 +1,64 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#pragma once
+#ifndef CONNECTIONTABLE_HPP
+#define CONNECTIONTABLE_HPP
+
+#include <cstddef>
+#include <vector>
+
+class Server;
+class RequestParser;
+class Response;
+
+enum ConnectionState {
+  CONN_FREE,
+  CONN_READING,
+  CONN_WRITING
+};
+
+// Client connections live in stable slots handed out from a free list, so
+// opening and closing one is O(1) and a slot index stays valid for the whole
+// life of the connection. Columns are kept as separate arrays: the ones read
+// on every iteration sit together, apart from the per-request objects that
+// are only dereferenced when the connection is actually dispatched.
+class ConnectionTable {
+ public:
+  ConnectionTable(void);
+  ~ConnectionTable(void);
+
+  void init(size_t reserve);
+  int insert(int fd, Server* server);
+  void remove(int slot);
+  int slot_of(int fd) const;
+  size_t size(void) const;
+  size_t capacity(void) const;
+
+  size_t limit;
+
+  // hot
+  std::vector<int> fd;
+  std::vector<short> events;
+  std::vector<size_t> deadline;
+  std::vector<unsigned char> state;
+
+  // cold
+  std::vector<Server*> server;
+  std::vector<RequestParser*> parser;
+  std::vector<Response*> response;
+
+ private:
+  ConnectionTable(const ConnectionTable&);
+  ConnectionTable& operator=(const ConnectionTable&);
+
+  std::vector<int> free_slots;
+  std::vector<int> by_fd;
+  size_t used;
+};
+
+#endif  // CONNECTIONTABLE_HPP
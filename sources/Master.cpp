@@ -0,0 +1,89 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#include "Master.hpp"
+
+#include <sys/prctl.h>
+#include <sys/wait.h>
+
+#include "WebServ.hpp"
+
+Master::Master(const Config& _conf): conf(_conf), alive(0) { }
+
+// returns the worker id in each child, the master only returns to exit
+int Master::run(void) {
+  workers.resize(conf.worker_processes, -1);
+  init_master_signals();
+  for (int id = 0; id < conf.worker_processes; id++) {
+    if (_spawn(id) == 0)
+      return id;
+  }
+  WebServ::log.info() << "WebServ master " << getpid() << " started "
+                      << conf.worker_processes << " workers\n";
+  return _supervise();
+}
+
+int Master::_spawn(int id) {
+  pid_t pid = fork();
+
+  if (pid == -1) {
+    WebServ::log.error() << "unable to fork worker " << id << ": "
+                         << strerror(errno) << "\n";
+    return -1;
+  }
+  if (pid == 0) {
+    std::signal(SIGTERM, SIG_DFL);
+    prctl(PR_SET_PDEATHSIG, SIGQUIT);
+    return 0;
+  }
+  workers[id] = pid;
+  alive++;
+  return pid;
+}
+
+int Master::_supervise(void) {
+  int status;
+  pid_t pid;
+
+  while (alive) {
+    pid = waitpid(-1, &status, 0);
+    if (master_signal)
+      _shutdown(master_signal);
+    if (pid == -1)
+      continue;
+    std::vector<pid_t>::iterator it =
+        std::find(workers.begin(), workers.end(), pid);
+    if (it == workers.end())
+      continue;
+    int id = it - workers.begin();
+    *it = -1;
+    alive--;
+    // a worker that exits on its own hit a config or bind error, starting it
+    // again would fail the same way
+    if (WIFEXITED(status)) {
+      WebServ::log.error() << "worker " << id << " exited with status "
+                           << WEXITSTATUS(status) << "\n";
+      continue;
+    }
+    WebServ::log.error() << "worker " << id << " killed by signal "
+                         << WTERMSIG(status) << ", respawning\n";
+    if (_spawn(id) == 0)
+      return id;
+  }
+  WebServ::log.error() << "WebServ master: no workers left\n";
+  exit(1);
+}
+
+void Master::_shutdown(int signal) {
+  for (size_t id = 0; id < workers.size(); id++) {
+    if (workers[id] != -1)
+      kill(workers[id], SIGQUIT);
+  }
+  while (waitpid(-1, NULL, 0) != -1 || errno == EINTR)
+    continue;
+  exit(128 + signal);
+}
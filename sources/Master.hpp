@@ -0,0 +1,37 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#pragma once
+#ifndef MASTER_HPP
+#define MASTER_HPP
+
+#include <sys/types.h>
+
+#include <vector>
+
+#include "Config.hpp"
+
+// With worker_processes above 1 the process that read the config becomes a
+// supervisor: it forks one event loop per worker, never accepts connections
+// itself and replaces workers that die from a crash.
+class Master {
+ public:
+  explicit Master(const Config& conf);
+
+  int run(void);
+
+ private:
+  int _spawn(int id);
+  int _supervise(void);
+  void _shutdown(int signal);
+
+  Config conf;
+  std::vector<pid_t> workers;
+  size_t alive;
+};
+
+#endif  // MASTER_HPP
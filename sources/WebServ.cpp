@@ -7,24 +7,22 @@
 
 #include "WebServ.hpp"
 
-s_request::s_request(void)
-: server(NULL), request_parser(NULL) {
-  timestamp = WebServ::get_time_in_ms();
-}
-s_request::s_request(Server *_server, int fd)
-: server(_server), request_parser(new RequestParser(fd)) {
-  timestamp = WebServ::get_time_in_ms();
-}
-
 Logger WebServ::log = WebServ::init_log();
+OpenFileCache WebServ::open_files;
+ResponseCache WebServ::response_cache;
+FastCgiPool WebServ::fastcgi;
+CgiPool WebServ::cgi_pool;
 Logger WebServ::init_log(void) {
   Logger logger(LOG_LEVEL);
   return logger;
 }
 
 WebServ::WebServ(void) {
+  loop = NULL;
+  now = get_time_in_ms();
   conn = 0;
-  compress = false;
+  worker = -1;
+  child_signal = -1;
 }
 
 WebServ::~WebServ(void) {
@@ -34,22 +32,22 @@ WebServ::~WebServ(void) {
   for (; it != ite; it++) {
     delete it->second;
   }
-  {
-    std::vector<_pollfd>::iterator it = pollfds.begin();
-    std::vector<_pollfd>::iterator ite = pollfds.end();
-    for (; it != ite; it++) {
-      if (serverlist.count(it->fd) || it->fd == -1)
-        continue;
-      delete clientlist[it->fd].request_parser;
-      delete clientlist[it->fd].response;
-      clientlist[it->fd].request_parser = NULL;
-      clientlist[it->fd].server = NULL;
-      it->fd = -1;
-    }
+  for (size_t slot = 0; slot < conns.capacity(); slot++) {
+    if (conns.state[slot] == CONN_FREE)
+      continue;
+    delete conns.parser[slot];
+    delete conns.response[slot];
+    close(conns.fd[slot]);
+    conns.remove(slot);
   }
+  delete loop;
+  if (response_cache.hits || response_cache.misses)
+    log.info() << "response cache: " << response_cache.hits << " hits, "
+               << response_cache.misses << " misses\n";
 }
 
-void WebServ::init(int argc, char **argv) {
+void WebServ::init(int argc, char **argv, int _worker) {
+  worker = _worker;
   log.info() << "WebServ Initializing\n";
 
   init_signals(this);
@@ -59,40 +57,57 @@ void WebServ::init(int argc, char **argv) {
   conf.load(argv[1]);
   log.info() << "WebServ Loaded " << argv[1] << "\n";
 
-  clientlist.reserve(conf.backlog);
-  clientlist.resize(conf.backlog);
+  conns.init(conf.backlog);
+  open_files.configure(conf.open_file_cache, conf.open_file_cache_valid,
+                       conf.open_file_cache_errors);
+  response_cache.configure(conf.response_cache, conf.response_cache_max_file);
+  fastcgi.configure(conf.fastcgi_keepalive);
+  if (worker != -1 && conf.worker_cpu_affinity)
+    pin_cpu();
+
+  loop = EventLoop::create(conf.event_method);
+  log.info() << "WebServ using " << loop->name() << " event loop\n";
 
   init_servers();
+  child_signal = init_child_signal();
+  if (child_signal == -1)
+    throw LoadException("could not create the SIGCHLD pipe");
+  loop->add(child_signal, POLLIN);
+  start_cgi_pools();
+  now = get_time_in_ms();
+  timers.init(now);
   log.info() << "WebServ initialized 🚀" << std::endl;
   std::for_each(serverlist.begin(), serverlist.end(), Server::print_addr);
 }
 
-bool WebServ::timed_out(int i) {
-  size_t time_now;
-  int fd = pollfds[i].fd;
+// pushes the idle deadline of a client forward, called on every event
+void WebServ::touch(int slot) {
+  conns.deadline[slot] = now + conns.server[slot]->timeout;
+  timers.schedule(slot, conns.deadline[slot]);
+}
+
+// between two requests a client gets keepalive_timeout to send the next one
+void WebServ::idle(int slot) {
+  conns.deadline[slot] = now + conns.server[slot]->keepalive_timeout;
+  timers.schedule(slot, conns.deadline[slot]);
+}
 
-  if (fd == -1)
-    return false;
-  time_now = WebServ::get_time_in_ms();
-  // WebServ::log.error() << (time_now - clientlist[fd].timestamp) << "\n";
-  if (time_now - clientlist[fd].timestamp > clientlist[fd].server->timeout) {
-    WebServ::log.info() << "Client " << fd << " timed out after "
-                        << (time_now - clientlist[fd].timestamp) << " ms\n";
-    return true;
-  }
-  return false;
+void WebServ::set_events(int slot, short events) {
+  if (conns.events[slot] == events)
+    return;
+  conns.events[slot] = events;
+  conns.state[slot] = (events & POLLOUT) ? CONN_WRITING : CONN_READING;
+  loop->modify(conns.fd[slot], events);
 }
 
 void WebServ::purge_timeouts(void) {
-  size_t time_now;
-
-  time_now = WebServ::get_time_in_ms();
-  std::vector<req>::iterator it = clientlist.begin();
-  for (; it != clientlist.end(); it++) {
-    if (time_now - it->timestamp > it->server->timeout) {
-      end_connection(it->request_parser->fd);
-      compress = true;
-    }
+  std::vector<int> expired;
+
+  timers.expire(now, &expired);
+  for (size_t i = 0; i < expired.size(); i++) {
+    int slot = expired[i];
+    WebServ::log.info() << "Client " << conns.fd[slot] << " timed out\n";
+    end_connection(conns.fd[slot]);
   }
 }
 
@@ -104,37 +119,56 @@ size_t WebServ::get_time_in_ms(void) {
 }
 
 int WebServ::_poll(void) {
-  conn = poll((struct pollfd *)&(*pollfds.begin()), pollfds.size(), -1);
+  conn = loop->wait(timers.next_timeout(get_time_in_ms()));
+  if (conn == -1 && errno == EINTR)
+    conn = 0;
+  now = get_time_in_ms();
   log.info() << "returned connections: " << conn << '\n';
   return conn;
 }
 
-void WebServ::_accept(int i) {
-  Server *host = serverlist[pollfds[i].fd];
+void WebServ::_accept(int fd) {
+  Server *host = serverlist[fd];
   int _fd;
 
-  log.info() << "Events detected in socket " << pollfds[i].fd << "\n";
-  _fd = accept(host->sockfd, NULL, NULL);
-  while (_fd != -1) {
-    clientlist[_fd].server = host;
+  log.info() << "Events detected in socket " << fd << "\n";
+  for (int budget = conf.accept_budget; budget > 0; budget--) {
+    _fd = loop->accept(host->sockfd);
+    if (_fd == -1) {
+      if (errno == ECONNABORTED || errno == EINTR)
+        continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        log.warning() << "accept: " << strerror(errno) << "\n";
+      return;
+    }
+    int slot = conns.insert(_fd, host);
+    if (slot == -1) {
+      log.warning() << "connection table full, refusing client " << _fd << "\n";
+      close(_fd);
+      continue;
+    }
     int max_body_size = host->client_max_body_size;
-    clientlist[_fd].request_parser = new RequestParser(_fd, max_body_size);
-    clientlist[_fd].response = new Response(NULL, host);
-    clientlist[_fd].timestamp = get_time_in_ms();
-    pollfds.push_back(_pollfd(_fd, POLLIN));
+    conns.parser[slot] = new RequestParser(_fd, max_body_size);
+    conns.parser[slot]->loop = loop;
+    conns.response[slot] = new Response(NULL, host);
+    loop->add_client(_fd, POLLIN);
+    touch(slot);
     log.info() << host->server_name[0]
                << " accepted connection of client "
                << _fd << "\n";
-    _fd = accept(host->sockfd, NULL, NULL);
   }
+  // the listener is edge triggered, what is left in its queue would not be
+  // reported again until a new client arrives
+  loop->post(fd, POLLIN);
 }
 
-void WebServ::_receive(int i) {
-  int fd = pollfds[i].fd;
-  RequestParser &parser = *clientlist[fd].request_parser;
-  Response &response = *clientlist[fd].response;
+void WebServ::_receive(int fd) {
+  int slot = conns.slot_of(fd);
+  RequestParser &parser = *conns.parser[slot];
+  Response &response = *conns.response[slot];
   response.parser = &parser;
 
+  touch(slot);
   // if (parser.is_header_finished()) {
   //   _respond(i);
   //   return;
@@ -148,92 +182,185 @@ void WebServ::_receive(int i) {
       parser.prepare_chunk();
       if (parser.is_chunk_ready()) {
         response.process();
+        if (await_cgi(slot))
+          return;
       }
-      pollfds[i].events = POLLIN;
     }
-    if (!parser.is_connected())
-      end_connection(i);
+    if (!parser.is_connected()) {
+      end_connection(fd);
+      return;
+    }
+    // a body that ended without a last chunk still ends the child's input
+    if (await_cgi(slot))
+      return;
     if (parser.finished)
-      pollfds[i].events = POLLOUT;
+      set_events(slot, POLLOUT);
+    else
+      set_events(slot, POLLIN);
   } catch (std::exception &e) {
     WebServ::log.error() << "exception caught while tokenizing request: "
                          << e.what() << std::endl;
-    end_connection(i);
+    end_connection(fd);
     return;
   }
 }
 
-void WebServ::_respond(int i) {
-  int fd = pollfds[i].fd;
-
-  RequestParser &parser = *clientlist[fd].request_parser;
-  Response &response = *clientlist[fd].response;
+void WebServ::_respond(int fd) {
+  int slot = conns.slot_of(fd);
+  RequestParser &parser = *conns.parser[slot];
+  Response &response = *conns.response[slot];
   response.parser = &parser;
 
+  touch(slot);
+  // the output of a running CGI, its pipe is watched again once it is out
+  if (response.cgi_fd() != -1) {
+    response._send(fd);
+    if (response.finished)
+      end_connection(fd);
+    else
+      await_cgi(slot);
+    return;
+  }
   if (response.req == NULL)
     response.set_request(&parser.get_request());
-  if (response.inprogress) {
+  if (response.pending()) {
+    response._send(fd);
+    if (response.pending())
+      return;
+  }
+  else if (response.inprogress) {
     response.assemble_followup();
     response._send(fd);
   }
   else if (parser.finished) {
     response.process();
+    if (await_cgi(slot))
+      return;
     response._send(fd);
   }
   else if (parser.is_header_finished()) {
     try {
       response.process();
+      if (await_cgi(slot))
+        return;
       if (parser.finished)
         response._send(fd);
     } catch (std::exception &e) {
       WebServ::log.error() << "exception caught while tokenizing request: "
                            << e.what() << std::endl;
-      end_connection(i);
+      end_connection(fd);
       return;
     }
   }
-  if (response.finished) {
-    pollfds[i].events = POLLIN;
-    if (response.response_code != 200)
-      close(pollfds[i].fd);
+  if (response.finished && !response.pending()) {
+    if (!response.keep_alive) {
+      end_connection(fd);
+      return;
+    }
     parser.reset();
     response.reset();
+    idle(slot);
+    if (!parser.buffered()) {
+      set_events(slot, POLLIN);
+      return;
+    }
+    // the next request of a pipeline is already in the parser's buffer, the
+    // socket may have nothing left to report
+    _receive(fd);
   }
 }
 
-void WebServ::end_connection(int i) {
-  int fd = pollfds[i].fd;
+// the client sleeps while its CGI runs, the output pipe or the FastCGI
+// connection stands in for it. It is woken to take what the child wrote,
+// and read while the child's stdin pipe keeps up with the body it sends.
+// While the client is slower than the child, the output pipe is left alone
+// and the child blocks on it.
+bool WebServ::await_cgi(int slot) {
+  Response &response = *conns.response[slot];
+  int input = response.cgi_input_fd();
+  short events = 0;
 
-  delete clientlist[fd].request_parser;
-  delete clientlist[fd].response;
-  clientlist[fd].request_parser = NULL;
-  clientlist[fd].server = NULL;
-  close(pollfds[i].fd);
-  log.info() << "Connection closed with client " << pollfds[i].fd << "\n";
-  pollfds[i].fd = -1;
-  compress = true;
+  if (response.cgi_fd() == -1)
+    return (false);
+  watch_cgi(slot, response.cgi_fd(),
+            response.pending() ? 0 : response.cgi_events());
+  if (input != -1 && response.input_done()) {
+    unwatch_cgi(input);
+    response.close_input();
+  } else if (input != -1) {
+    watch_cgi(slot, input, response.cgi_input_events());
+  }
+  if (response.pending())
+    events |= POLLOUT;
+  if (!conns.parser[slot]->finished && response.wants_body())
+    events |= POLLIN;
+  set_events(slot, events);
+  return (true);
 }
 
-void WebServ::purge_conns(void) {
-  // TODO(VLN37): see if necessary to remove timeouts here
-  // purge_timeouts();
-  std::vector<_pollfd>::iterator it = pollfds.begin();
-  std::vector<_pollfd>::iterator ite = pollfds.end();
-  for (; it != ite; it++) {
-    if (it->fd == -1) {
-      pollfds.erase(it);
-      ite--;
-      if (it == ite)
-        break;
+void WebServ::watch_cgi(int slot, int fd, short events) {
+  std::map<int, CgiWatch>::iterator it = cgi_pipes.find(fd);
+
+  if (it == cgi_pipes.end()) {
+    CgiWatch watch = {conns.fd[slot], events};
+    loop->add(fd, events);
+    cgi_pipes[fd] = watch;
+  } else if (it->second.events != events) {
+    it->second.events = events;
+    loop->modify(fd, events);
+  }
+}
+
+void WebServ::unwatch_cgi(int fd) {
+  if (fd != -1 && cgi_pipes.count(fd)) {
+    loop->remove(fd);
+    cgi_pipes.erase(fd);
+  }
+}
+
+// what the CGI wrote goes out right away
+void WebServ::_cgi(int fd) {
+  int client = cgi_pipes[fd].client;
+  int slot = conns.slot_of(client);
+  Response &response = *conns.response[slot];
+
+  touch(slot);
+  if (response.cgi_io()) {
+    unwatch_cgi(response.cgi_fd());
+    unwatch_cgi(response.cgi_input_fd());
+    response.finish_cgi();
+    set_events(slot, POLLOUT);
+    return;
+  }
+  if (response.pending()) {
+    response._send(client);
+    if (response.finished) {
+      end_connection(client);
+      return;
     }
   }
+  await_cgi(slot);
+}
+
+void WebServ::end_connection(int fd) {
+  int slot = conns.slot_of(fd);
+
+  unwatch_cgi(conns.response[slot]->cgi_fd());
+  unwatch_cgi(conns.response[slot]->cgi_input_fd());
+  delete conns.parser[slot];
+  delete conns.response[slot];
+  timers.cancel(slot);
+  conns.remove(slot);
+  loop->remove(fd);
+  close(fd);
+  log.info() << "Connection closed with client " << fd << "\n";
 }
 
 void WebServ::init_servers(void) {
   for (size_t i = 0; i < conf.size(); i++) {
     Server *srv = new Server(conf[i]);
     try {
-      srv->_connect(conf.backlog);
+      srv->_connect(conf.backlog, worker != -1);
     } catch (LoadException &e) {
       delete srv, throw e;
     }
@@ -246,6 +373,34 @@ void WebServ::init_servers(void) {
       }
     }
     serverlist.insert(std::make_pair(srv->sockfd, srv));
-    pollfds.push_back(_pollfd(srv->sockfd, POLLIN));
+    loop->add_listener(srv->sockfd);
   }
 }
+
+// pooled interpreters are started with the server so the first requests
+// find them warm
+void WebServ::start_cgi_pools(void) {
+  std::map<int, Server *>::iterator srv = serverlist.begin();
+  for (; srv != serverlist.end(); srv++) {
+    std::map<std::string, std::pair<int, int> >::iterator it;
+    for (it = srv->second->cgi_pool.begin();
+         it != srv->second->cgi_pool.end(); it++)
+      cgi_pool.start(srv->second->cgi[it->first], it->second.first);
+  }
+}
+
+void WebServ::pin_cpu(void) {
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  cpu_set_t set;
+
+  if (cpus < 1)
+    return;
+  CPU_ZERO(&set);
+  CPU_SET(worker % cpus, &set);
+  if (sched_setaffinity(0, sizeof(set), &set) == -1)
+    log.warning() << "worker " << worker << " could not be pinned: "
+                  << strerror(errno) << "\n";
+  else
+    log.info() << "worker " << worker << " pinned to cpu "
+               << worker % cpus << "\n";
+}
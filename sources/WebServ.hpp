@@ -12,6 +12,7 @@
 #include <fcntl.h>
 #include <netdb.h>
 #include <poll.h>
+#include <sched.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -30,17 +31,25 @@
 #include <vector>
 
 #include "Config.hpp"
-#include "ResponseBase.hpp"
+#include "ConnectionTable.hpp"
+#include "EventLoop.hpp"
+#include "FastCgi.hpp"
+#include "CgiPool.hpp"
 #include "Request.hpp"
 #include "Response.hpp"
 #include "LoadException.hpp"
 #include "Logger.hpp"
+#include "Master.hpp"
+#include "OpenFileCache.hpp"
 #include "Pollfd.hpp"
 #include "RequestParser.hpp"
+#include "ResponseCache.hpp"
 #include "Server.hpp"
 #include "ServerLocation.hpp"
 #include "String.hpp"
+#include "TimerWheel.hpp"
 #include "defines.hpp"
+#include "precompress.hpp"
 #include "signal.hpp"
 #include "validate_input.hpp"
 
@@ -48,14 +57,11 @@ class Request;
 class Response;
 typedef struct addrinfo s_addrinfo;
 
-typedef struct s_request {
-  s_request();
-  s_request(Server *_server, int fd);
-  Server *server;
-  RequestParser *request_parser;
-  Response *response;
-  size_t timestamp;
-} req;
+// a CGI output pipe or FastCGI connection and the client it answers
+struct CgiWatch {
+  int client;
+  short events;
+};
 
 class WebServ {
  public:
@@ -63,26 +69,41 @@ class WebServ {
 
   WebServ(void);
   ~WebServ(void);
-  void init(int argc, char **argv);
+  void init(int argc, char **argv, int worker = -1);
   int _poll(void);
   void _accept(int fd);
   void _receive(int fd);
   void _respond(int fd);
+  void _cgi(int fd);
+  bool await_cgi(int slot);
   void end_connection(int fd);
-  void purge_conns(void);
   void purge_timeouts(void);
-  bool timed_out(int fd);
+  void touch(int slot);
+  void idle(int slot);
+  void set_events(int slot, short events);
   static Logger init_log(void);
   void init_servers(void);
+  void pin_cpu(void);
+  void start_cgi_pools(void);
+  void watch_cgi(int slot, int fd, short events);
+  void unwatch_cgi(int fd);
 
  public:
   Config conf;
   std::map<int, Server *> serverlist;
-  std::vector<req> clientlist;
-  std::vector<_pollfd> pollfds;
+  std::map<int, CgiWatch> cgi_pipes;
+  int child_signal;
+  ConnectionTable conns;
+  EventLoop *loop;
+  TimerWheel timers;
   static Logger log;
+  static OpenFileCache open_files;
+  static ResponseCache response_cache;
+  static FastCgiPool fastcgi;
+  static CgiPool cgi_pool;
+  size_t now;
   int conn;
-  int compress;
+  int worker;
 };
 
 #endif  // WEBSERV_HPP
@@ -12,6 +12,23 @@
 
 // Server host default
 #define DFL_BACKLOG 500
+#define DFL_EVENT_METHOD "epoll"
+#define DFL_EVENTS 64
+#define DFL_MAX_EVENTS 4096
+#define DFL_URING_ENTRIES 256
+#define DFL_URING_BUFFERS 64
+#define DFL_URING_BUFFER_SIZE 16384
+#define DFL_WORKER_PROCESSES 1
+#define DFL_WORKER_CPU_AFFINITY 0
+#define DFL_ACCEPT_BUDGET 64
+#define DFL_OPEN_FILE_CACHE 1024
+#define DFL_OPEN_FILE_CACHE_VALID 10000
+#define DFL_OPEN_FILE_CACHE_ERRORS 1
+#define DFL_RESPONSE_CACHE 8388608
+#define DFL_RESPONSE_CACHE_MAX_FILE 65536
+#define DFL_FASTCGI_KEEPALIVE 16
+#define DFL_CGI_POOL_REQUESTS 1000
+#define DFL_CGI_HEADER_MAX 16384
 // Server vhost default
 #define DFL_ADDRESS "127.0.0.1"
 #define DFL_PORT 8080
@@ -22,9 +39,22 @@
 #define DFL_404_PAGE "custom_404.html"
 #define DFL_405_PAGE "custom_405.html"
 #define DFL_TIMEOUT 300
+#define DFL_TIMER_TICK 10
+#define DFL_KEEPALIVE_REQUESTS 1000
+#define DFL_KEEPALIVE_TIMEOUT 75000
 #define DFL_CLI_MAX_BODY_SIZE 1024000000
+#define DFL_CLI_BODY_BUFFER_SIZE 16384
 
 #define DFL_AUTO_INDEX 0
+#define DFL_SENDFILE 1
+#define DFL_GZIP_STATIC 0
+#define DFL_BROTLI_STATIC 0
+#define DFL_GZIP 0
+#define DFL_GZIP_TYPES "text/html"
+#define DFL_GZIP_MIN_LENGTH 20
+#define DFL_GZIP_COMP_LEVEL 1
+#define DFL_PRECOMPRESS_TYPES \
+  ".html .htm .css .js .json .svg .txt .xml"
 #define DFL_SOCK_FD -1
 #define DFL_UPLOAD 0
 #define DFL_UPLOAD_STORE "/tmp"
@@ -32,15 +62,37 @@
 #define DFL_LIM_EXCEPT "ALL"
 
 #define CFG_FIELD_UNIQUE "server"
-#define CFG_FIELD_DOUBLE "error_page cgi return location"
+#define CFG_FIELD_DOUBLE \
+  "error_page cgi fastcgi_pass cgi_pool return location add_header"
 #define CFG_MIN_BACKLOG 1
 #define CFG_MAX_BACKLOG 4096
+#define CFG_FIELD_EVENT_METHOD "poll epoll io_uring"
+#define CFG_FIELD_GLOBAL \
+  "workers backlog use worker_processes worker_cpu_affinity accept_budget " \
+  "open_file_cache open_file_cache_valid open_file_cache_errors " \
+  "response_cache response_cache_max_file fastcgi_keepalive"
+#define CFG_MIN_WORKER_PROCESSES 1
+#define CFG_MAX_WORKER_PROCESSES 64
+#define CFG_MIN_ACCEPT_BUDGET 1
+#define CFG_MAX_ACCEPT_BUDGET 4096
+#define CFG_MAX_OPEN_FILE_CACHE 65536
+#define CFG_MAX_OPEN_FILE_CACHE_VALID 3600000
+#define CFG_MAX_RESPONSE_CACHE 1073741824
+#define CFG_MAX_FASTCGI_KEEPALIVE 4096
+#define CFG_MAX_CGI_POOL 256
+// sizeof(sockaddr_un::sun_path)
+#define CFG_MAX_UNIX_PATH 108
+#define CFG_MAX_EXPIRES 315360000
+#define CFG_MIN_GZIP_COMP_LEVEL 1
+#define CFG_MAX_GZIP_COMP_LEVEL 9
 #define CFG_MIN_ERR_CODE 400
 #define CFG_MAX_ERR_CODE 499
 #define CFG_MIN_TIMEOUT 0
 #define CFG_MAX_TIMEOUT 500000000
+#define CFG_MAX_KEEPALIVE_REQUESTS 1000000
 #define CFG_MIN_CLI_MAX_BODY_SIZE 0
 #define CFG_MAX_CLI_MAX_BODY_SIZE 1024000
+#define CFG_MAX_CLI_BODY_BUFFER_SIZE 67108864
 #define CFG_MIN_RED_CODE 100
 #define CFG_MAX_RED_CODE 499
 #define CFG_FIELD_LIM_EXCEPT "ALL GET POST PUT DELETE"
@@ -61,6 +113,7 @@
 #define MULTIPLE_CHOICE 300
 #define MOVED_PERMANENTLY 301
 #define FOUND 302
+#define NOT_MODIFIED 304
 
 #define BAD_REQUEST 400
 #define UNAUTHORIZED 401
@@ -87,6 +140,10 @@
 
 #define DFL_CONTENTTYPE "Content-Type: text/html; charset=utf-8\n"
 #define DFL_CONTENTLEN "Content-Length: LENGTH\n\n"
+#define DFL_GZIPCHUNKED \
+  "Content-Encoding: gzip\nTransfer-Encoding: chunked\n\n"
+#define DFL_CHUNKED "Transfer-Encoding: chunked\n\n"
 #define DFL_SEPARATOR "42__SEPARATOR__42\n"
+#define DFL_MAX_RANGES 64
 #define MULTIPART "Content-Type: multipart/byteranges; boundary=" DFL_SEPARATOR
 #endif  // DEFINES_H
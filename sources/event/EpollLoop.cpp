@@ -0,0 +1,105 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#include "EpollLoop.hpp"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "WebServ.hpp"
+
+// no EPOLLRDHUP: a client that shut down its side after sending a request
+// still waits for the answer, the end of its stream is seen by recv()
+static uint32_t to_epoll(short events) {
+  uint32_t ev = 0;
+
+  if (events & POLLIN)
+    ev |= EPOLLIN;
+  if (events & POLLOUT)
+    ev |= EPOLLOUT;
+  return ev;
+}
+
+static short from_epoll(uint32_t ev) {
+  short events = 0;
+
+  if (ev & EPOLLIN)
+    events |= POLLIN;
+  if (ev & EPOLLOUT)
+    events |= POLLOUT;
+  if (ev & EPOLLERR)
+    events |= POLLERR;
+  if (ev & EPOLLHUP)
+    events |= POLLHUP;
+  return events;
+}
+
+EpollLoop::EpollLoop(void) {
+  epfd = epoll_create1(EPOLL_CLOEXEC);
+  if (epfd == -1)
+    throw InitException("epoll_create1");
+  events.resize(DFL_EVENTS);
+}
+
+EpollLoop::EpollLoop(const EpollLoop&): EventLoop() { }
+
+EpollLoop& EpollLoop::operator=(const EpollLoop&) { return *this; }
+
+EpollLoop::~EpollLoop(void) {
+  close(epfd);
+}
+
+void EpollLoop::_ctl(int op, int fd, short ev) {
+  struct epoll_event event;
+
+  std::memset(&event, 0, sizeof(event));
+  event.events = to_epoll(ev);
+  if (edge_triggered[fd])
+    event.events |= EPOLLET;
+  event.data.fd = fd;
+  if (epoll_ctl(epfd, op, fd, &event) == -1)
+    WebServ::log.error() << "epoll_ctl on fd " << fd << ": "
+                         << strerror(errno) << "\n";
+}
+
+void EpollLoop::add(int fd, short ev, bool edge) {
+  if (fd >= static_cast<int>(edge_triggered.size()))
+    edge_triggered.resize(fd + 1, false);
+  edge_triggered[fd] = edge;
+  _ctl(EPOLL_CTL_ADD, fd, ev);
+}
+
+void EpollLoop::modify(int fd, short ev) {
+  _ctl(EPOLL_CTL_MOD, fd, ev);
+}
+
+void EpollLoop::remove(int fd) {
+  epoll_ctl(epfd, EPOLL_CTL_DEL, fd, NULL);
+  discard(fd);
+}
+
+const char* EpollLoop::name(void) const {
+  return "epoll";
+}
+
+int EpollLoop::wait(int timeout) {
+  int conn;
+
+  ready.clear();
+  conn = epoll_wait(epfd, &events[0], events.size(), poll_timeout(timeout));
+  if (conn == -1)
+    return conn;
+  for (int i = 0; i < conn; i++)
+    ready.push_back(_pollfd(events[i].data.fd, 0, from_epoll(events[i].events)));
+  // a full batch means more descriptors were ready than we could take
+  if (conn == static_cast<int>(events.size()) && events.size() < DFL_MAX_EVENTS)
+    events.resize(events.size() * 2);
+  take_posted();
+  return ready.size();
+}
@@ -0,0 +1,44 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#pragma once
+#ifndef EPOLLLOOP_HPP
+#define EPOLLLOOP_HPP
+
+#include <sys/epoll.h>
+
+#include <vector>
+
+#include "EventLoop.hpp"
+
+// epoll(7) backend. Listeners are edge triggered and drained by accept4()
+// until EAGAIN. Clients stay level triggered: a response sends one buffer per
+// event and a request is read one buffer at a time, so what is left must be
+// reported again without a new edge.
+class EpollLoop : public EventLoop {
+ public:
+  EpollLoop(void);
+  ~EpollLoop(void);
+
+  void add(int fd, short events, bool edge = false);
+  void modify(int fd, short events);
+  void remove(int fd);
+  int wait(int timeout);
+  const char* name(void) const;
+
+ private:
+  EpollLoop(const EpollLoop&);
+  EpollLoop& operator=(const EpollLoop&);
+
+  void _ctl(int op, int fd, short events);
+
+  int epfd;
+  std::vector<struct epoll_event> events;
+  std::vector<char> edge_triggered;
+};
+
+#endif  // EPOLLLOOP_HPP
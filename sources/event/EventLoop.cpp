@@ -0,0 +1,104 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#include "EventLoop.hpp"
+
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "EpollLoop.hpp"
+#include "PollLoop.hpp"
+#include "UringLoop.hpp"
+#include "WebServ.hpp"
+
+EventLoop::~EventLoop(void) { }
+
+EventLoop* EventLoop::create(const std::string& method) {
+  if (method == "io_uring") {
+    try {
+      return new UringLoop();
+    } catch (InitException& e) {
+      WebServ::log.warning() << e.what() << ", falling back to epoll\n";
+    }
+  }
+  if (method == "io_uring" || method == "epoll") {
+    try {
+      return new EpollLoop();
+    } catch (InitException& e) {
+      WebServ::log.warning() << e.what() << ", falling back to poll\n";
+    }
+  }
+  return new PollLoop();
+}
+
+// listeners are edge triggered, WebServ drains them until accept() fails
+void EventLoop::add_listener(int fd) {
+  add(fd, POLLIN, true);
+}
+
+void EventLoop::add_client(int fd, short events) {
+  add(fd, events);
+}
+
+int EventLoop::accept(int fd) {
+  return accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+}
+
+ssize_t EventLoop::recv(int fd, char* buf, size_t len) {
+  return ::recv(fd, buf, len, 0);
+}
+
+// a descriptor closed while handling an earlier event of the same batch must
+// not be dispatched again, its number may already belong to a new client
+void EventLoop::discard(int fd) {
+  std::vector<_pollfd>::iterator it = ready.begin();
+  for (; it != ready.end(); it++) {
+    if (it->fd == fd)
+      it->revents = 0;
+  }
+  for (it = posted.begin(); it != posted.end(); it++) {
+    if (it->fd == fd)
+      it->revents = 0;
+  }
+}
+
+// queues an event the kernel will not report again by itself (an edge
+// triggered descriptor left with work), it is delivered by the next wait()
+void EventLoop::post(int fd, short revents) {
+  posted.push_back(_pollfd(fd, 0, revents));
+}
+
+// posted events must not wait behind a blocking call
+int EventLoop::poll_timeout(int timeout) const {
+  if (posted.empty())
+    return timeout;
+  return 0;
+}
+
+void EventLoop::take_posted(void) {
+  for (size_t i = 0; i < posted.size(); i++) {
+    if (!posted[i].revents)
+      continue;
+    size_t j = 0;
+    while (j < ready.size() && ready[j].fd != posted[i].fd)
+      j++;
+    if (j == ready.size())
+      ready.push_back(posted[i]);
+  }
+  posted.clear();
+}
+
+EventLoop::InitException::InitException(const std::string& str)
+    : LoadException(str) {
+  _m = "WebServ Failed to start event loop (" + str + "): " + strerror(errno);
+}
+
+const char* EventLoop::InitException::what(void) const throw() {
+  return (_m.c_str());
+}
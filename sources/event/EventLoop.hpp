@@ -0,0 +1,66 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#pragma once
+#ifndef EVENTLOOP_HPP
+#define EVENTLOOP_HPP
+
+#include <poll.h>
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+#include "LoadException.hpp"
+#include "Pollfd.hpp"
+#include "defines.hpp"
+
+// Readiness notification backend. Events are expressed with the poll(2)
+// constants regardless of the backend, and every call to wait() refills
+// `ready` with only the descriptors that have something to report.
+//
+// Listeners and clients are registered apart and connections are taken and
+// read through accept() and recv(): a completion based backend has already
+// done the syscall when it reports POLLIN and hands out its result, the
+// others make it then.
+class EventLoop {
+ public:
+  virtual ~EventLoop(void);
+
+  virtual void add(int fd, short events, bool edge = false) = 0;
+  virtual void modify(int fd, short events) = 0;
+  virtual void remove(int fd) = 0;
+  virtual int wait(int timeout) = 0;
+  virtual const char* name(void) const = 0;
+
+  virtual void add_listener(int fd);
+  virtual void add_client(int fd, short events);
+  virtual int accept(int fd);
+  virtual ssize_t recv(int fd, char* buf, size_t len);
+
+  static EventLoop* create(const std::string& method);
+
+  void post(int fd, short revents);
+
+  std::vector<_pollfd> ready;
+
+ protected:
+  void discard(int fd);
+  int poll_timeout(int timeout) const;
+  void take_posted(void);
+
+  std::vector<_pollfd> posted;
+
+ public:
+  class InitException : public LoadException {
+   public:
+    explicit InitException(const std::string& str);
+    const char* what(void) const throw();
+  };
+};
+
+#endif  // EVENTLOOP_HPP
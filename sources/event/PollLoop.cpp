@@ -0,0 +1,56 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#include "PollLoop.hpp"
+
+PollLoop::PollLoop(void) { }
+
+PollLoop::~PollLoop(void) { }
+
+void PollLoop::add(int fd, short events, bool edge) {
+  (void)edge;
+  if (fd >= static_cast<int>(index.size()))
+    index.resize(fd + 1, -1);
+  index[fd] = pollfds.size();
+  pollfds.push_back(_pollfd(fd, events));
+}
+
+void PollLoop::modify(int fd, short events) {
+  pollfds[index[fd]].events = events;
+}
+
+// the last entry takes the place of the removed one, ready was already
+// copied out of pollfds so reordering it mid-dispatch is harmless
+void PollLoop::remove(int fd) {
+  int pos = index[fd];
+
+  pollfds[pos] = pollfds.back();
+  index[pollfds[pos].fd] = pos;
+  pollfds.pop_back();
+  index[fd] = -1;
+  discard(fd);
+}
+
+const char* PollLoop::name(void) const {
+  return "poll";
+}
+
+int PollLoop::wait(int timeout) {
+  int conn;
+
+  ready.clear();
+  conn = poll((struct pollfd *)&(*pollfds.begin()), pollfds.size(),
+              poll_timeout(timeout));
+  if (conn == -1)
+    return conn;
+  for (size_t i = 0; conn && i < pollfds.size(); i++) {
+    if (pollfds[i].revents)
+      ready.push_back(pollfds[i]);
+  }
+  take_posted();
+  return ready.size();
+}
@@ -5,8 +5,28 @@
 //#                         Welton Leite - wleite                              #
 //##############################################################################
 
-#include "ResponseBase.hpp"
+#pragma once
+#ifndef POLLLOOP_HPP
+#define POLLLOOP_HPP
 
-char ResponseBase::buffer_req[BUFFER_SIZE] = "";
-char ResponseBase::buffer_resp[HEADER_SIZE + BUFFER_SIZE] = "";
-int  ResponseBase::size = 42;
+#include <vector>
+
+#include "EventLoop.hpp"
+
+class PollLoop : public EventLoop {
+ public:
+  PollLoop(void);
+  ~PollLoop(void);
+
+  void add(int fd, short events, bool edge = false);
+  void modify(int fd, short events);
+  void remove(int fd);
+  int wait(int timeout);
+  const char* name(void) const;
+
+ private:
+  std::vector<_pollfd> pollfds;
+  std::vector<int> index;
+};
+
+#endif  // POLLLOOP_HPP
@@ -0,0 +1,135 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#include "TimerWheel.hpp"
+
+#include <algorithm>
+
+TimerWheel::TimerWheel(size_t _tick)
+: tick(_tick), current(0), count(0),
+  buckets(WHEEL_LEVELS * WHEEL_SLOTS, -1) { }
+
+void TimerWheel::init(size_t now) {
+  current = now / tick;
+}
+
+// places a node in the bucket matching how far in the future it expires
+void TimerWheel::_link(int id) {
+  Node& node = nodes[id];
+  size_t span = WHEEL_SLOTS;
+  int level = 0;
+
+  node.expires = std::max(node.deadline, current + 1);
+  while (level < WHEEL_LEVELS - 1 && node.expires - current >= span) {
+    span <<= WHEEL_BITS;
+    level++;
+  }
+  if (node.expires - current >= span)
+    node.expires = current + span - 1;
+  size_t slot = (node.expires >> (level * WHEEL_BITS)) & WHEEL_MASK;
+  node.bucket = level * WHEEL_SLOTS + slot;
+  node.prev = -1;
+  node.next = buckets[node.bucket];
+  if (node.next != -1)
+    nodes[node.next].prev = id;
+  buckets[node.bucket] = id;
+}
+
+void TimerWheel::_unlink(int id) {
+  Node& node = nodes[id];
+
+  if (node.prev != -1)
+    nodes[node.prev].next = node.next;
+  else
+    buckets[node.bucket] = node.next;
+  if (node.next != -1)
+    nodes[node.next].prev = node.prev;
+  node.bucket = -1;
+}
+
+void TimerWheel::schedule(int id, size_t deadline) {
+  if (id >= static_cast<int>(nodes.size())) {
+    Node empty = { -1, -1, -1, 0, 0 };
+    nodes.resize(id + 1, empty);
+  }
+  if (nodes[id].bucket != -1)
+    _unlink(id);
+  else
+    count++;
+  nodes[id].deadline = (deadline + tick - 1) / tick;
+  _link(id);
+}
+
+void TimerWheel::cancel(int id) {
+  if (id >= static_cast<int>(nodes.size()) || nodes[id].bucket == -1)
+    return;
+  _unlink(id);
+  count--;
+}
+
+// re-files every timer of the current upper level slot one level down
+void TimerWheel::_cascade(int level) {
+  int bucket = level * WHEEL_SLOTS +
+               ((current >> (level * WHEEL_BITS)) & WHEEL_MASK);
+  int id = buckets[bucket];
+
+  buckets[bucket] = -1;
+  while (id != -1) {
+    int next = nodes[id].next;
+    _link(id);
+    id = next;
+  }
+}
+
+void TimerWheel::expire(size_t now, std::vector<int>* expired) {
+  size_t target = now / tick;
+
+  if (count == 0) {
+    current = std::max(current, target);
+    return;
+  }
+  while (current < target) {
+    current++;
+    if ((current & WHEEL_MASK) == 0) {
+      int level = 1;
+      while (level < WHEEL_LEVELS - 1 &&
+             ((current >> (level * WHEEL_BITS)) & WHEEL_MASK) == 0)
+        level++;
+      for (; level > 0; level--)
+        _cascade(level);
+    }
+    int bucket = current & WHEEL_MASK;
+    while (buckets[bucket] != -1) {
+      int id = buckets[bucket];
+      _unlink(id);
+      // clamped into the outermost level, still not due
+      if (nodes[id].deadline > current) {
+        _link(id);
+        continue;
+      }
+      count--;
+      expired->push_back(id);
+    }
+  }
+}
+
+// milliseconds until the wheel needs to be advanced again, -1 when idle
+int TimerWheel::next_timeout(size_t now) const {
+  if (count == 0)
+    return -1;
+  for (size_t t = current + 1; t <= current + WHEEL_SLOTS; t++) {
+    if (buckets[t & WHEEL_MASK] != -1)
+      return t * tick > now ? t * tick - now : 0;
+    if ((t & WHEEL_MASK) == 0)
+      return t * tick > now ? t * tick - now : 0;
+  }
+  return tick;
+}
+
+size_t TimerWheel::size(void) const {
+  return count;
+}
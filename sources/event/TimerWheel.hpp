@@ -0,0 +1,57 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#pragma once
+#ifndef TIMERWHEEL_HPP
+#define TIMERWHEEL_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "defines.hpp"
+
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS 4
+
+// Hierarchical timing wheel keyed by small integer ids. Level 0 has one slot
+// per tick, each upper level covers WHEEL_SLOTS times the span of the one
+// below and is cascaded down when the lower level wraps, so scheduling,
+// cancelling and expiring a timer are all O(1) amortized.
+class TimerWheel {
+ public:
+  explicit TimerWheel(size_t tick = DFL_TIMER_TICK);
+
+  void init(size_t now);
+  void schedule(int id, size_t deadline);
+  void cancel(int id);
+  void expire(size_t now, std::vector<int>* expired);
+  int next_timeout(size_t now) const;
+  size_t size(void) const;
+
+ private:
+  struct Node {
+    int prev;
+    int next;
+    int bucket;
+    size_t deadline;
+    size_t expires;
+  };
+
+  void _link(int id);
+  void _unlink(int id);
+  void _cascade(int level);
+
+  size_t tick;
+  size_t current;
+  size_t count;
+  std::vector<Node> nodes;
+  std::vector<int> buckets;
+};
+
+#endif  // TIMERWHEEL_HPP
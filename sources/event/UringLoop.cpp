@@ -0,0 +1,527 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#include "UringLoop.hpp"
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "WebServ.hpp"
+
+// user_data layout: [63:61] request kind, [60:32] generation, [31:0] fd
+#define URING_POLL 0
+#define URING_REMOVE 1
+#define URING_TIMEOUT 2
+#define URING_ACCEPT 3
+#define URING_RECV 4
+#define URING_CANCEL 5
+#define URING_BUFFERS 6
+
+// what the ring does for a descriptor
+#define ROLE_POLL 0
+#define ROLE_LISTENER 1
+#define ROLE_CLIENT 2
+
+static __u64 pack(__u64 kind, unsigned gen, int fd) {
+  return (kind << 61) | ((__u64)(gen & 0x1fffffff) << 32) | (__u32)fd;
+}
+
+static __u64 kind_of(__u64 data) { return data >> 61; }
+static unsigned gen_of(__u64 data) { return (data >> 32) & 0x1fffffff; }
+static int fd_of(__u64 data) { return (int)(data & 0xffffffff); }
+
+UringLoop::UringLoop(void): ring_fd(-1), to_submit(0), sq_ptr(MAP_FAILED),
+  sqes(reinterpret_cast<struct io_uring_sqe*>(MAP_FAILED)),
+  cq_ptr(MAP_FAILED), buffers(DFL_URING_BUFFERS * DFL_URING_BUFFER_SIZE),
+  provide_error(0), multishot(true) {
+  struct io_uring_params p;
+
+  std::memset(&p, 0, sizeof(p));
+  ring_fd = syscall(__NR_io_uring_setup, DFL_URING_ENTRIES, &p);
+  if (ring_fd == -1)
+    throw InitException("io_uring_setup");
+  try {
+    _map_rings(&p);
+    // a kernel without provided buffers could not read for the clients
+    _provide(0, DFL_URING_BUFFERS);
+    if (_enter(1) == -1)
+      throw InitException("io_uring_enter");
+    _reap();
+    if (provide_error) {
+      errno = provide_error;
+      throw InitException("IORING_OP_PROVIDE_BUFFERS");
+    }
+  } catch (InitException& e) {
+    _release();
+    throw;
+  }
+}
+
+UringLoop::UringLoop(const UringLoop&): EventLoop() { }
+
+UringLoop& UringLoop::operator=(const UringLoop&) { return *this; }
+
+UringLoop::~UringLoop(void) {
+  std::map<int, std::deque<int> >::iterator it = accepted.begin();
+  for (; it != accepted.end(); it++) {
+    for (size_t i = 0; i < it->second.size(); i++)
+      if (it->second[i] >= 0)
+        close(it->second[i]);
+  }
+  _release();
+}
+
+// unmaps the rings and closes them, whatever part of them was set up
+void UringLoop::_release(void) {
+  if (sqes != MAP_FAILED)
+    munmap(sqes, sqes_size);
+  if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr)
+    munmap(cq_ptr, cq_size);
+  if (sq_ptr != MAP_FAILED)
+    munmap(sq_ptr, sq_size);
+  sq_ptr = cq_ptr = MAP_FAILED;
+  sqes = reinterpret_cast<struct io_uring_sqe*>(MAP_FAILED);
+  if (ring_fd != -1)
+    close(ring_fd);
+  ring_fd = -1;
+}
+
+void UringLoop::_map_rings(struct io_uring_params* p) {
+  char* sq;
+  char* cq;
+
+  sq_size = p->sq_off.array + p->sq_entries * sizeof(unsigned);
+  cq_size = p->cq_off.cqes + p->cq_entries * sizeof(struct io_uring_cqe);
+  if (p->features & IORING_FEAT_SINGLE_MMAP)
+    sq_size = cq_size = std::max(sq_size, cq_size);
+  sq_ptr = mmap(NULL, sq_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  if (sq_ptr == MAP_FAILED)
+    throw InitException("mmap");
+  if (p->features & IORING_FEAT_SINGLE_MMAP) {
+    cq_ptr = sq_ptr;
+  } else {
+    cq_ptr = mmap(NULL, cq_size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+    if (cq_ptr == MAP_FAILED)
+      throw InitException("mmap");
+  }
+  sqes_size = p->sq_entries * sizeof(struct io_uring_sqe);
+  sqes = reinterpret_cast<struct io_uring_sqe*>(
+      mmap(NULL, sqes_size, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES));
+  if (sqes == MAP_FAILED)
+    throw InitException("mmap");
+
+  sq = static_cast<char*>(sq_ptr);
+  sq_head = reinterpret_cast<unsigned*>(sq + p->sq_off.head);
+  sq_tail = reinterpret_cast<unsigned*>(sq + p->sq_off.tail);
+  sq_mask = reinterpret_cast<unsigned*>(sq + p->sq_off.ring_mask);
+  sq_entries = reinterpret_cast<unsigned*>(sq + p->sq_off.ring_entries);
+  sq_array = reinterpret_cast<unsigned*>(sq + p->sq_off.array);
+  cq = static_cast<char*>(cq_ptr);
+  cq_head = reinterpret_cast<unsigned*>(cq + p->cq_off.head);
+  cq_tail = reinterpret_cast<unsigned*>(cq + p->cq_off.tail);
+  cq_mask = reinterpret_cast<unsigned*>(cq + p->cq_off.ring_mask);
+  cqes = reinterpret_cast<struct io_uring_cqe*>(cq + p->cq_off.cqes);
+}
+
+// returns a zeroed slot at the submission tail, flushing the ring when full
+struct io_uring_sqe* UringLoop::_sqe(void) {
+  unsigned tail = *sq_tail;
+
+  if (tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) >= *sq_entries)
+    _enter(0);
+  struct io_uring_sqe* sqe = &sqes[tail & *sq_mask];
+  std::memset(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+void UringLoop::_queue(void) {
+  unsigned tail = *sq_tail;
+
+  sq_array[tail & *sq_mask] = tail & *sq_mask;
+  __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+  to_submit++;
+}
+
+int UringLoop::_enter(unsigned wait_nr) {
+  unsigned flags = wait_nr ? IORING_ENTER_GETEVENTS : 0;
+  int ret;
+
+  ret = syscall(__NR_io_uring_enter, ring_fd, to_submit, wait_nr, flags,
+                NULL, 0);
+  if (ret == -1) {
+    if (errno != EINTR)
+      WebServ::log.error() << "io_uring_enter: " << strerror(errno) << "\n";
+    return -1;
+  }
+  to_submit -= std::min(to_submit, static_cast<unsigned>(ret));
+  return ret;
+}
+
+// a descriptor number may be reused, whatever it did before is forgotten
+void UringLoop::_track(int fd, int what) {
+  if (fd >= static_cast<int>(interest.size())) {
+    UringRecv none = {0, 0, 0, false};
+    interest.resize(fd + 1, 0);
+    role.resize(fd + 1, ROLE_POLL);
+    generation.resize(fd + 1, 0);
+    life.resize(fd + 1, 0);
+    armed.resize(fd + 1, false);
+    reading.resize(fd + 1, false);
+    received.resize(fd + 1, none);
+  }
+  role[fd] = what;
+  generation[fd]++;
+  life[fd]++;
+  armed[fd] = false;
+  reading[fd] = false;
+  received[fd].done = false;
+  rearm.push_back(fd);
+}
+
+// a listener waits for connections, a client that reads for its bytes and
+// what it waits for besides, or anything else, with a poll
+void UringLoop::_arm(int fd) {
+  short events = interest[fd];
+
+  if (role[fd] == ROLE_LISTENER) {
+    if (!armed[fd])
+      _arm_accept(fd);
+    return;
+  }
+  if (role[fd] == ROLE_CLIENT) {
+    if ((events & POLLIN) && !reading[fd] && !received[fd].done)
+      _arm_recv(fd);
+    events &= ~POLLIN;
+  }
+  if (events && !armed[fd])
+    _arm_poll(fd, events);
+}
+
+void UringLoop::_arm_poll(int fd, short events) {
+  struct io_uring_sqe* sqe = _sqe();
+
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = events;
+  sqe->user_data = pack(URING_POLL, generation[fd], fd);
+  _queue();
+  armed[fd] = true;
+}
+
+void UringLoop::_arm_accept(int fd) {
+  struct io_uring_sqe* sqe = _sqe();
+
+  sqe->opcode = IORING_OP_ACCEPT;
+  sqe->fd = fd;
+  sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+  if (multishot)
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+  sqe->user_data = pack(URING_ACCEPT, life[fd], fd);
+  _queue();
+  armed[fd] = true;
+}
+
+// the kernel picks a free buffer once bytes arrive, an idle client holds none
+void UringLoop::_arm_recv(int fd) {
+  struct io_uring_sqe* sqe = _sqe();
+
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = fd;
+  sqe->len = DFL_URING_BUFFER_SIZE;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = 0;
+  sqe->user_data = pack(URING_RECV, life[fd], fd);
+  _queue();
+  reading[fd] = true;
+}
+
+// gives `count` buffers starting at `buffer` (back) to the kernel
+void UringLoop::_provide(unsigned buffer, unsigned count) {
+  struct io_uring_sqe* sqe = _sqe();
+
+  sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+  sqe->fd = count;
+  sqe->addr = reinterpret_cast<__u64>(&buffers[buffer * DFL_URING_BUFFER_SIZE]);
+  sqe->len = DFL_URING_BUFFER_SIZE;
+  sqe->off = buffer;
+  sqe->buf_group = 0;
+  sqe->user_data = pack(URING_BUFFERS, 0, 0);
+  _queue();
+}
+
+// the pending poll
+void UringLoop::_cancel(int fd) {
+  if (armed[fd] && role[fd] != ROLE_LISTENER) {
+    struct io_uring_sqe* sqe = _sqe();
+
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->addr = pack(URING_POLL, generation[fd], fd);
+    sqe->user_data = pack(URING_REMOVE, 0, fd);
+    _queue();
+    armed[fd] = false;
+  }
+  generation[fd]++;
+}
+
+void UringLoop::_cancel_request(__u64 data) {
+  struct io_uring_sqe* sqe = _sqe();
+
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->addr = data;
+  sqe->user_data = pack(URING_CANCEL, 0, fd_of(data));
+  _queue();
+}
+
+void UringLoop::add(int fd, short events, bool edge) {
+  (void)edge;
+  _track(fd, ROLE_POLL);
+  interest[fd] = events;
+}
+
+void UringLoop::add_listener(int fd) {
+  _track(fd, ROLE_LISTENER);
+  interest[fd] = POLLIN;
+}
+
+void UringLoop::add_client(int fd, short events) {
+  _track(fd, ROLE_CLIENT);
+  interest[fd] = events;
+}
+
+// a client's recv is left running when it stops reading, what it gets is
+// kept for when it reads again
+void UringLoop::modify(int fd, short events) {
+  short before = interest[fd];
+
+  if (role[fd] == ROLE_CLIENT) {
+    if ((before ^ events) & ~POLLIN)
+      _cancel(fd);
+    if ((events & POLLIN) && !(before & POLLIN) && received[fd].done)
+      post(fd, POLLIN);
+  } else {
+    if (before == events && armed[fd])
+      return;
+    _cancel(fd);
+  }
+  interest[fd] = events;
+  rearm.push_back(fd);
+}
+
+// pending requests hold a reference to the socket, so their cancellation is
+// submitted right away or the peer would not see the close until next wait()
+void UringLoop::remove(int fd) {
+  _cancel(fd);
+  if (role[fd] == ROLE_LISTENER && armed[fd])
+    _cancel_request(pack(URING_ACCEPT, life[fd], fd));
+  if (role[fd] == ROLE_CLIENT && reading[fd])
+    _cancel_request(pack(URING_RECV, life[fd], fd));
+  if (received[fd].done && received[fd].res > 0)
+    _provide(received[fd].buffer, 1);
+  received[fd].done = false;
+  reading[fd] = false;
+  armed[fd] = false;
+  life[fd]++;
+  interest[fd] = 0;
+  if (to_submit)
+    _enter(0);
+  discard(fd);
+}
+
+// the next connection the listener took
+int UringLoop::accept(int fd) {
+  std::deque<int>& queue = accepted[fd];
+
+  if (queue.empty()) {
+    errno = EAGAIN;
+    return -1;
+  }
+  int res = queue.front();
+  queue.pop_front();
+  if (res < 0) {
+    errno = -res;
+    return -1;
+  }
+  return res;
+}
+
+// copies out what the last recv got, the buffer goes back to the kernel
+// once empty and the next recv is armed. EAGAIN while one is in flight
+ssize_t UringLoop::recv(int fd, char* buf, size_t len) {
+  if (fd >= static_cast<int>(role.size()) || role[fd] != ROLE_CLIENT)
+    return ::recv(fd, buf, len, 0);
+  UringRecv& got = received[fd];
+  if (!got.done) {
+    errno = EAGAIN;
+    return -1;
+  }
+  // out of buffers: this one is read directly
+  if (got.res == -ENOBUFS) {
+    got.done = false;
+    rearm.push_back(fd);
+    return ::recv(fd, buf, len, 0);
+  }
+  if (got.res <= 0) {
+    errno = -got.res;
+    return got.res ? -1 : 0;
+  }
+  size_t size = std::min(len, static_cast<size_t>(got.res) - got.taken);
+  std::memcpy(buf, &buffers[got.buffer * DFL_URING_BUFFER_SIZE + got.taken],
+              size);
+  got.taken += size;
+  if (got.taken == static_cast<size_t>(got.res)) {
+    _provide(got.buffer, 1);
+    got.done = false;
+    rearm.push_back(fd);
+  } else {
+    post(fd, POLLIN);
+  }
+  return size;
+}
+
+const char* UringLoop::name(void) const {
+  return "io_uring";
+}
+
+// a descriptor may get a poll and a recv completion in the same batch
+void UringLoop::_report(int fd, short revents) {
+  for (size_t i = 0; i < ready.size(); i++) {
+    if (ready[i].fd == fd) {
+      ready[i].revents |= revents;
+      return;
+    }
+  }
+  ready.push_back(_pollfd(fd, interest[fd], revents));
+}
+
+void UringLoop::_complete_poll(struct io_uring_cqe* cqe) {
+  int fd = fd_of(cqe->user_data);
+
+  if (gen_of(cqe->user_data) != generation[fd] || interest[fd] == 0)
+    return;
+  armed[fd] = false;
+  rearm.push_back(fd);
+  // the kernel reports POLLRDHUP whether it was asked for or not, a client
+  // that shut down its side still waits for the answer
+  if (cqe->res < 0)
+    _report(fd, POLLERR);
+  else
+    _report(fd, cqe->res & ~POLLRDHUP);
+}
+
+// connections are queued for accept(), failures too so that WebServ sees
+// them. A kernel without multishot accept fails it and gets one per request
+void UringLoop::_complete_accept(struct io_uring_cqe* cqe) {
+  int fd = fd_of(cqe->user_data);
+
+  if (gen_of(cqe->user_data) != life[fd] || role[fd] != ROLE_LISTENER) {
+    if (cqe->res >= 0)
+      close(cqe->res);
+    return;
+  }
+  if (!(cqe->flags & IORING_CQE_F_MORE)) {
+    armed[fd] = false;
+    rearm.push_back(fd);
+  }
+  if (cqe->res == -EINVAL && multishot) {
+    multishot = false;
+    return;
+  }
+  accepted[fd].push_back(cqe->res);
+  _report(fd, POLLIN);
+}
+
+// the bytes wait in their buffer until recv() takes them. A completion for a
+// client that is gone only gives its buffer back
+void UringLoop::_complete_recv(struct io_uring_cqe* cqe) {
+  int fd = fd_of(cqe->user_data);
+  unsigned buffer = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+
+  if (gen_of(cqe->user_data) != life[fd] || role[fd] != ROLE_CLIENT) {
+    if (cqe->flags & IORING_CQE_F_BUFFER)
+      _provide(buffer, 1);
+    return;
+  }
+  UringRecv got = {cqe->res, buffer, 0, true};
+  received[fd] = got;
+  reading[fd] = false;
+  if (interest[fd] & POLLIN)
+    _report(fd, POLLIN);
+}
+
+// moves completions into the ready list, returns whether the timeout fired
+bool UringLoop::_reap(void) {
+  unsigned head = *cq_head;
+  unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+  bool expired = false;
+
+  for (; head != tail; head++) {
+    struct io_uring_cqe* cqe = &cqes[head & *cq_mask];
+
+    switch (kind_of(cqe->user_data)) {
+      case URING_TIMEOUT:
+        expired |= (cqe->res == -ETIME);
+        break;
+      case URING_POLL:
+        _complete_poll(cqe);
+        break;
+      case URING_ACCEPT:
+        _complete_accept(cqe);
+        break;
+      case URING_RECV:
+        _complete_recv(cqe);
+        break;
+      case URING_BUFFERS:
+        if (cqe->res < 0) {
+          provide_error = -cqe->res;
+          WebServ::log.error() << "io_uring provide buffers: "
+                               << strerror(provide_error) << "\n";
+        }
+        break;
+    }
+  }
+  __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+  return expired;
+}
+
+int UringLoop::wait(int timeout) {
+  bool expired = false;
+
+  ready.clear();
+  timeout = poll_timeout(timeout);
+  while (ready.empty() && !expired) {
+    std::vector<int> pending;
+    pending.swap(rearm);
+    for (size_t i = 0; i < pending.size(); i++) {
+      if (interest[pending[i]])
+        _arm(pending[i]);
+    }
+    if (timeout >= 0) {
+      struct io_uring_sqe* sqe = _sqe();
+      ts.tv_sec = timeout / 1000;
+      ts.tv_nsec = (timeout % 1000) * 1000000L;
+      sqe->opcode = IORING_OP_TIMEOUT;
+      sqe->addr = reinterpret_cast<__u64>(&ts);
+      sqe->len = 1;
+      sqe->off = 1;
+      sqe->user_data = pack(URING_TIMEOUT, 0, 0);
+      _queue();
+    }
+    if (_enter(1) == -1)
+      return -1;
+    expired = _reap();
+  }
+  take_posted();
+  return ready.size();
+}
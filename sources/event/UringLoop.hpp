@@ -0,0 +1,112 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#pragma once
+#ifndef URINGLOOP_HPP
+#define URINGLOOP_HPP
+
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "EventLoop.hpp"
+
+// a recv that completed into a provided buffer, taken by recv() in pieces
+struct UringRecv {
+  int res;
+  unsigned buffer;
+  size_t taken;
+  bool done;
+};
+
+// io_uring backend. Listeners get a multishot IORING_OP_ACCEPT and clients
+// that want to read an IORING_OP_RECV into one of the ring's provided
+// buffers, so by the time POLLIN is reported the connection was accepted
+// or the bytes read, and accept() and recv() only hand them out. Anything
+// else, writes included, is waited for with one-shot IORING_OP_POLL_ADD
+// requests. Requests are (re-)armed in bulk at the start of every wait(), so
+// a whole iteration worth of them and the wait itself cost a single
+// io_uring_enter(2).
+class UringLoop : public EventLoop {
+ public:
+  UringLoop(void);
+  ~UringLoop(void);
+
+  void add(int fd, short events, bool edge = false);
+  void modify(int fd, short events);
+  void remove(int fd);
+  int wait(int timeout);
+  const char* name(void) const;
+
+  void add_listener(int fd);
+  void add_client(int fd, short events);
+  int accept(int fd);
+  ssize_t recv(int fd, char* buf, size_t len);
+
+ private:
+  UringLoop(const UringLoop&);
+  UringLoop& operator=(const UringLoop&);
+
+  void _map_rings(struct io_uring_params* p);
+  void _release(void);
+  struct io_uring_sqe* _sqe(void);
+  void _queue(void);
+  int _enter(unsigned wait_nr);
+  void _track(int fd, int role);
+  void _arm(int fd);
+  void _arm_poll(int fd, short events);
+  void _arm_accept(int fd);
+  void _arm_recv(int fd);
+  void _provide(unsigned buffer, unsigned count);
+  void _cancel(int fd);
+  void _cancel_request(__u64 data);
+  void _report(int fd, short revents);
+  void _complete_poll(struct io_uring_cqe* cqe);
+  void _complete_accept(struct io_uring_cqe* cqe);
+  void _complete_recv(struct io_uring_cqe* cqe);
+  bool _reap(void);
+
+  int ring_fd;
+  unsigned to_submit;
+
+  void* sq_ptr;
+  size_t sq_size;
+  unsigned* sq_head;
+  unsigned* sq_tail;
+  unsigned* sq_mask;
+  unsigned* sq_entries;
+  unsigned* sq_array;
+  struct io_uring_sqe* sqes;
+  size_t sqes_size;
+
+  void* cq_ptr;
+  size_t cq_size;
+  unsigned* cq_head;
+  unsigned* cq_tail;
+  unsigned* cq_mask;
+  struct io_uring_cqe* cqes;
+
+  struct __kernel_timespec ts;
+
+  std::vector<short> interest;
+  std::vector<char> role;
+  std::vector<unsigned> generation;
+  std::vector<unsigned> life;
+  std::vector<char> armed;
+  std::vector<char> reading;
+  std::vector<UringRecv> received;
+  std::vector<int> rearm;
+  std::map<int, std::deque<int> > accepted;
+  std::vector<char> buffers;
+  int provide_error;
+  bool multishot;
+};
+
+#endif  // URINGLOOP_HPP
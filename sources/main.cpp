@@ -7,45 +7,68 @@
 
 #include "WebServ.hpp"
 
-void loop(int argc, char** argv) {
+void loop(int argc, char** argv, int worker) {
   WebServ webserv;
 
-  webserv.init(argc, argv);
+  webserv.init(argc, argv, worker);
   while (true) {
     webserv._poll();
-    if (webserv.conn <= 0)
+    if (webserv.conn < 0)
       break;
-    for (int i = 0, size = webserv.pollfds.size(); i < size; i++) {
-      int16_t revents = webserv.pollfds[i].revents;
-      bool server_request = webserv.serverlist.count(webserv.pollfds[i].fd);
+    std::vector<_pollfd>& ready = webserv.loop->ready;
+    for (size_t i = 0; i < ready.size(); i++) {
+      int fd = ready[i].fd;
+      int16_t revents = ready[i].revents;
+      bool server_request = webserv.serverlist.count(fd);
       if (revents == 0)
         continue;
-      if (!server_request && webserv.timed_out(i)) {
-        webserv.end_connection(i);
-        continue;
-      }
       if (server_request) {
-        webserv._accept(i);
+        webserv._accept(fd);
+      } else if (webserv.cgi_pipes.count(fd)) {
+        webserv._cgi(fd);
+      } else if (fd == webserv.child_signal) {
+        reap_children();
       } else {
         if (revents & (POLLERR | POLLRDHUP | POLLNVAL | POLLHUP))
-            webserv.end_connection(i);
+            webserv.end_connection(fd);
         else if (revents & POLLIN)
-          webserv._receive(i);
+          webserv._receive(fd);
         else if (revents & POLLOUT)
-          webserv._respond(i);
+          webserv._respond(fd);
         else
           WebServ::log.warning() << "unexpected error returned on poll";
       }
     }
-    if (webserv.compress)
-      webserv.purge_conns();
+    webserv.purge_timeouts();
   }
 }
 
+// returns -1 when running as a single process, the worker id otherwise
+int spawn_workers(int argc, char** argv) {
+  Config conf;
+
+  validate_input(argc, argv);
+  conf.load(argv[1]);
+  if (conf.worker_processes == 1)
+    return -1;
+  Master master(conf);
+  return master.run();
+}
+
 int main(int argc, char** argv) {
+  int worker;
+
+  if (argc == 3 && std::string(argv[1]) == "--precompress")
+    return (precompress(argv[2]));
+  try {
+    worker = spawn_workers(argc, argv);
+  } catch (LoadException& e) {
+    WebServ::log.error() << e.what() << std::endl;
+    return (1);
+  }
   while (true) {
     try {
-      loop(argc, argv);
+      loop(argc, argv, worker);
       break;
     } catch (LoadException& e) {
       WebServ::log.error() << e.what() << std::endl;
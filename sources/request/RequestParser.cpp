@@ -116,11 +116,28 @@ static inline bool str_iequals(const std::string& str1, const std::string& str2)
   return true;
 }
 
+// header names are case-insensitive, they are stored as Content-Type so
+// lookups do not depend on how the client spelled them
+static std::string canonical_header_key(const std::string& key) {
+  std::string canonical(key);
+  bool upper = true;
+
+  for (size_t i = 0; i < canonical.size(); i++) {
+    if (upper)
+      canonical[i] = std::toupper(canonical[i]);
+    else
+      canonical[i] = std::tolower(canonical[i]);
+    upper = (canonical[i] == '-');
+  }
+  return canonical;
+}
+
 std::string RequestParser::supported_version = "HTTP/1.1";
 
 RequestParser::RequestParser(int fd, size_t max_body_size, size_t buffer_size):
   fd(fd),
   finished(false),
+  loop(NULL),
   valid(false),
   connected(true),
   header_finished(false),
@@ -174,8 +191,6 @@ void print_chunk(std::ostream& out, const char *str, size_t start, size_t size)
  * */
 
 ParsingResult RequestParser::tokenize_header(char *buff) {
-  i = 0;
-
   while (i < bytes_read) {
     char c = buff[i++];
 
@@ -267,6 +282,7 @@ ParsingResult RequestParser::tokenize_header(char *buff) {
 
       case S_HEADER_LINE_KEY:
         if (c == ':') {
+          _header_key = canonical_header_key(_header_key);
           _request->headers[_header_key];
           header_state = S_HEADER_LINE_SPACE;
         } else if (is_ctl(c) || is_separator(c)) {
@@ -480,16 +496,27 @@ ParsingResult RequestParser::tokenize_chunk_size(char *buff) {
   return P_PARSING_INCOMPLETE;
 }
 
+ssize_t RequestParser::_read() {
+  if (loop != NULL)
+    return loop->recv(fd, buffer, buffer_size);
+  return recv(fd, buffer, buffer_size, 0);
+}
+
 void RequestParser::parse_header() {
   if (header_finished)
     throw HeaderFinishedException();
   if (!connected)
     throw ConnectionClosedException();
 
-  bytes_read = recv(fd, buffer, buffer_size, 0);
-
-  check_read_value(bytes_read);
-  info() << "bytes read: " << bytes_read << std::endl;
+  // a pipelining client may have sent this request along with the last one
+  if (!buffered()) {
+    bytes_read = _read();
+    i = 0;
+    if (!check_read_value(bytes_read))
+      return;
+    info() << "bytes read: " << bytes_read << std::endl;
+  } else
+    info() << "parsing " << (bytes_read - i) << " buffered bytes\n";
 
   try {
     ParsingResult result = tokenize_header(buffer);
@@ -513,8 +540,14 @@ void RequestParser::parse_header() {
   }
 }
 
-void RequestParser::check_read_value(size_t bytes_read) {
+// the socket is non-blocking: false means nothing has arrived yet and the
+// caller should wait for the next readiness event
+bool RequestParser::check_read_value(size_t bytes_read) {
   if (bytes_read == (size_t)-1) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      this->bytes_read = 0;
+      return false;
+    }
     throw ReadException(strerror(errno));
   } else if (bytes_read == 0) {
     this->header_finished = true;
@@ -525,21 +558,23 @@ void RequestParser::check_read_value(size_t bytes_read) {
       << std::endl;
     throw ConnectionClosedException();
   }
+  return true;
 }
 
 bool RequestParser::prepare_chunked_body() {
   info() << "preparing a chunked body\n";
 
-  if (i == bytes_read) {
+  if (!buffered()) {
     if (just_finished_header) {
       debug() << "must poll again\n";
       just_finished_header = false;
       return false;
     }
     info() << "reading a new chunk\n";
-    bytes_read = recv(fd, buffer, buffer_size, 0);
-    check_read_value(bytes_read);
+    bytes_read = _read();
     i = 0;
+    if (!check_read_value(bytes_read))
+      return false;
   } else
     info() << "using remaining chunk in the buffer\n";
 
@@ -561,10 +596,8 @@ bool RequestParser::prepare_chunked_body() {
 bool RequestParser::prepare_regular_body() {
   info() << "preparing a regular body\n";
 
-  if (i < bytes_read) {
-    info() << "using remaining" << (bytes_read - i) << "bytes from buffer\n";
-    chunk_data.assign(buffer + i, buffer + bytes_read);
-    body_bytes_so_far = bytes_read - i;
+  if (buffered()) {
+    info() << "using remaining " << (bytes_read - i) << " bytes from buffer\n";
   } else {
     if (just_finished_header) {
       debug() << "must poll again\n";
@@ -572,23 +605,24 @@ bool RequestParser::prepare_regular_body() {
       return false;
     }
     info() << "reading more bytes\n";
-    bytes_read = recv(fd, buffer, buffer_size, 0);
-    check_read_value(bytes_read);
-    body_bytes_so_far += bytes_read;
+    bytes_read = _read();
+    i = 0;
+    if (!check_read_value(bytes_read))
+      return false;
     info() << bytes_read << " bytes where read" << std::endl;
-    chunk_data.assign(buffer, buffer + bytes_read);
   }
 
-  i = -1;
+  // whatever follows content-length bytes is the next request
+  size_t size = bytes_read - i;
+  if (size > content_length - body_bytes_so_far)
+    size = content_length - body_bytes_so_far;
+  chunk_data.assign(buffer + i, buffer + i + size);
+  i += size;
+  body_bytes_so_far += size;
 
-  if (content_length > 0) {
-    if (body_bytes_so_far > content_length) {
-      finished = true;
-      throw InvalidRequestException(RequestEntityTooLarge);
-    } else if (body_bytes_so_far == content_length) {
-      info() << "all content-length was read" << std::endl;
-      finished = true;
-    }
+  if (body_bytes_so_far == content_length) {
+    info() << "all content-length was read" << std::endl;
+    finished = true;
   }
   return true;
 }
@@ -649,6 +683,11 @@ bool RequestParser::is_header_finished() const {
   return header_finished;
 }
 
+// bytes received but not parsed yet, the start of a pipelined request
+bool RequestParser::buffered() const {
+  return i < bytes_read;
+}
+
 void RequestParser::reset() {
   debug() << "reseting..." << std::endl;
   delete this->_request;
@@ -669,9 +708,8 @@ void RequestParser::reset() {
   chunk_ready = 0;
   chunk_data.clear();
 
-  // buffer iterator;
-  i = 0;
-  bytes_read = 0;
+  // the buffer and its iterator are kept, they may already hold the start
+  // of the next request
 
   _header_key = "";
   _header_value = "";
@@ -6,6 +6,8 @@
 #include "Logger.hpp"
 #include "defines.hpp"
 
+#include <sys/types.h>
+
 #include <exception>
 #include <string>
 #include <vector>
@@ -75,6 +77,8 @@ enum RequestErrors {
   HttpVersionUnsupported = HTTP_VERSION_UNSUPPORTED
 };
 
+class EventLoop;
+
 class RequestParser
 {
   RequestParser(const RequestParser &);
@@ -82,12 +86,15 @@ class RequestParser
 public:
   int fd;
   bool finished;
+  // reads go through it when set, it may have done them already
+  EventLoop* loop;
 
   RequestParser(int fd = -1, size_t max_body_size = 0, size_t buffer_max = 65536);
   ~RequestParser();
 
   bool is_connected() const;
   bool is_header_finished() const;
+  bool buffered() const;
 
   void parse_header();
 
@@ -130,6 +137,8 @@ public:
   };
 
 private:
+  ssize_t _read();
+
   bool valid;
   bool connected;
 
@@ -172,7 +181,7 @@ private:
   bool prepare_chunked_body();
   bool prepare_regular_body();
 
-  void check_read_value(size_t bytes_read);
+  bool check_read_value(size_t bytes_read);
 
   // utils
   std::ostream& debug();
@@ -0,0 +1,41 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#include "BufferPool.hpp"
+
+BufferPool::BufferPool(size_t buffer_size, size_t max_idle)
+    : size(buffer_size), max_idle(max_idle) { }
+
+BufferPool::BufferPool(const BufferPool&) { }
+
+BufferPool& BufferPool::operator=(const BufferPool&) { return *this; }
+
+BufferPool::~BufferPool(void) {
+  for (size_t i = 0; i < idle.size(); i++)
+    delete[] idle[i];
+}
+
+char* BufferPool::acquire(void) {
+  char* buffer;
+
+  if (idle.empty()) {
+    buffer = new char[size];
+  } else {
+    buffer = idle.back();
+    idle.pop_back();
+  }
+  return (buffer);
+}
+
+void BufferPool::release(char* buffer) {
+  if (buffer == NULL)
+    return;
+  if (idle.size() < max_idle)
+    idle.push_back(buffer);
+  else
+    delete[] buffer;
+}
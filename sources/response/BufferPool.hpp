@@ -0,0 +1,39 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#pragma once
+#ifndef BUFFERPOOL_HPP
+#define BUFFERPOOL_HPP
+
+#include <cstddef>
+#include <vector>
+
+#define BUFFER_SIZE 100000
+#define POOL_MAX_IDLE 32
+
+// Fixed-size body buffers handed to in-flight responses. A released buffer
+// is kept for the next response, up to max_idle of them, so memory follows
+// the number of responses actually being sent instead of a shared scratch
+// area every connection writes into.
+class BufferPool {
+ public:
+  BufferPool(size_t buffer_size, size_t max_idle);
+  ~BufferPool(void);
+
+  char* acquire(void);
+  void release(char* buffer);
+
+ private:
+  BufferPool(const BufferPool&);
+  BufferPool& operator=(const BufferPool&);
+
+  std::vector<char*> idle;
+  size_t size;
+  size_t max_idle;
+};
+
+#endif  // BUFFERPOOL_HPP
@@ -0,0 +1,202 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#include "CgiPool.hpp"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
+
+#include "signal.hpp"
+
+// the request loop every worker runs, scripts are executed in the worker
+// with their stdin, stdout and environment swapped for the request's. What
+// a script changes in the interpreter, its imports, cwd, environment and
+// sys.path, is rolled back before the next request.
+static const char* runner =
+    "import io, os, runpy, struct, sys, traceback\n"
+    "rd = os.fdopen(0, 'rb', 0)\n"
+    "wr = os.fdopen(1, 'wb', 0)\n"
+    "modules = dict(sys.modules)\n"
+    "cwd = os.getcwd()\n"
+    "environ = dict(os.environ)\n"
+    "path = list(sys.path)\n"
+    "argv = list(sys.argv)\n"
+    "def frame():\n"
+    "    head = rd.read(4)\n"
+    "    if len(head) < 4:\n"
+    "        sys.exit(0)\n"
+    "    size = struct.unpack('>I', head)[0]\n"
+    "    data = b''\n"
+    "    while len(data) < size:\n"
+    "        chunk = rd.read(size - len(data))\n"
+    "        if not chunk:\n"
+    "            sys.exit(0)\n"
+    "        data += chunk\n"
+    "    return data\n"
+    "def restore():\n"
+    "    for name in list(sys.modules):\n"
+    "        if name not in modules:\n"
+    "            del sys.modules[name]\n"
+    "    sys.modules.update(modules)\n"
+    "    os.chdir(cwd)\n"
+    "    os.environ.clear()\n"
+    "    os.environ.update(environ)\n"
+    "    sys.path[:] = path\n"
+    "    sys.argv[:] = argv\n"
+    "while True:\n"
+    "    env = frame().split(b'\\0')\n"
+    "    env = dict(v.decode().split('=', 1) for v in env if v)\n"
+    "    body = frame()\n"
+    "    os.environ.clear()\n"
+    "    os.environ.update(env)\n"
+    "    out = io.BytesIO()\n"
+    "    sys.stdin = io.TextIOWrapper(io.BytesIO(body))\n"
+    "    sys.stdout = io.TextIOWrapper(out, write_through=True)\n"
+    "    try:\n"
+    "        runpy.run_path(env['SCRIPT_FILENAME'], run_name='__main__')\n"
+    "    except SystemExit:\n"
+    "        pass\n"
+    "    except BaseException:\n"
+    "        traceback.print_exc()\n"
+    "    sys.stdout.flush()\n"
+    "    data = out.getvalue()\n"
+    "    wr.write(struct.pack('>I', len(data)) + data)\n"
+    "    try:\n"
+    "        restore()\n"
+    "    except BaseException:\n"
+    "        sys.exit(1)\n";
+
+CgiPool::CgiPool(void) {}
+
+CgiPool::~CgiPool(void) {
+  while (workers.size())
+    _drop(workers.begin());
+}
+
+// tops the workers of `bin` up to `size`
+void CgiPool::start(const std::string& bin, size_t size) {
+  size_t count = 0;
+
+  std::list<CgiWorker>::iterator it = workers.begin();
+  for (; it != workers.end(); it++)
+    if (it->bin == bin)
+      count++;
+  for (; count < size; count++)
+    if (_spawn(bin) == NULL)
+      return;
+}
+
+// an idle worker of `bin`, or a new one while the pool is not full. NULL
+// when all of them are busy, the request is then run the usual way
+CgiWorker* CgiPool::acquire(const std::string& bin, size_t size) {
+  size_t count = 0;
+  char c;
+
+  std::list<CgiWorker>::iterator it = workers.begin();
+  while (it != workers.end()) {
+    if (it->bin != bin) {
+      it++;
+      continue;
+    }
+    if (it->busy) {
+      count++, it++;
+      continue;
+    }
+    // a worker that has exited shows up as the end of its socket
+    if (recv(it->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == -1 &&
+        errno == EAGAIN) {
+      it->busy = true;
+      return (&*it);
+    }
+    _drop(it++);
+  }
+  if (count >= size)
+    return (NULL);
+  CgiWorker* worker = _spawn(bin);
+  if (worker != NULL)
+    worker->busy = true;
+  return (worker);
+}
+
+// a retired worker is replaced right away to keep the pool warm
+void CgiPool::release(CgiWorker* worker, bool reusable, size_t max_requests) {
+  std::list<CgiWorker>::iterator it = workers.begin();
+
+  while (it != workers.end() && &*it != worker)
+    it++;
+  if (it == workers.end())
+    return;
+  it->busy = false;
+  if (reusable && ++it->served < max_requests)
+    return;
+  std::string bin(it->bin);
+  _drop(it);
+  _spawn(bin);
+}
+
+void CgiPool::frame(size_t len, std::string* out) {
+  out->push_back(static_cast<char>((len >> 24) & 0xff));
+  out->push_back(static_cast<char>((len >> 16) & 0xff));
+  out->push_back(static_cast<char>((len >> 8) & 0xff));
+  out->push_back(static_cast<char>(len & 0xff));
+}
+
+// 1 once `in` holds the whole reply, which is moved to `out`
+int CgiPool::parse(std::string* in, std::string* out) {
+  if (in->size() < CGIPOOL_FRAME_HEADER)
+    return (0);
+  const unsigned char* h = reinterpret_cast<const unsigned char*>(in->data());
+  size_t len = (static_cast<size_t>(h[0]) << 24) | (h[1] << 16) |
+               (h[2] << 8) | h[3];
+  if (in->size() - CGIPOOL_FRAME_HEADER < len)
+    return (0);
+  out->assign(*in, CGIPOOL_FRAME_HEADER, len);
+  in->clear();
+  return (1);
+}
+
+CgiWorker* CgiPool::_spawn(const std::string& bin) {
+  int sv[2];
+  pid_t pid;
+
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) == -1)
+    return (NULL);
+  pid = fork();
+  if (pid == 0) {
+    dup2(sv[1], STDIN_FILENO);
+    dup2(sv[1], STDOUT_FILENO);
+    execl(bin.c_str(), bin.c_str(), "-c", runner, (char*)NULL);
+    _exit(1);
+  }
+  close(sv[1]);
+  if (pid == -1) {
+    close(sv[0]);
+    return (NULL);
+  }
+  track_child(pid);
+  fcntl(sv[0], F_SETFL, O_NONBLOCK);
+  CgiWorker worker;
+  worker.bin = bin;
+  worker.pid = pid;
+  worker.fd = sv[0];
+  worker.served = 0;
+  worker.busy = false;
+  workers.push_back(worker);
+  return (&workers.back());
+}
+
+// the worker is killed rather than asked to leave, it may be in the middle
+// of a request. One that already exited and was reaped is left alone.
+void CgiPool::_drop(std::list<CgiWorker>::iterator it) {
+  close(it->fd);
+  kill_child(it->pid);
+  workers.erase(it);
+}
@@ -0,0 +1,61 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#pragma once
+#ifndef CGIPOOL_HPP
+#define CGIPOOL_HPP
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <list>
+#include <string>
+
+// a length prefix, 4 bytes in network order, in front of every frame
+#define CGIPOOL_FRAME_HEADER 4
+
+// an interpreter running the request loop of CgiPool, the server holds one
+// end of a socketpair that is the worker's stdin and stdout
+struct CgiWorker {
+  std::string bin;
+  pid_t pid;
+  int fd;
+  size_t served;
+  bool busy;
+};
+
+// Python interpreters started once and fed CGI requests one after the other
+// instead of a fork and exec per request. A request is two frames, the
+// environment as NUL separated "NAME=value" strings and the body, and the
+// reply is one frame with what the script printed. Workers are started up to
+// the size of the pool and replaced once they have served their quota of
+// requests or failed one. Imports, cwd and environment are rolled back after
+// every script, but state a script leaves in modules that were already loaded
+// survives until the worker is replaced: a low quota bounds it.
+class CgiPool {
+ public:
+  CgiPool(void);
+  ~CgiPool(void);
+
+  void start(const std::string& bin, size_t size);
+  CgiWorker* acquire(const std::string& bin, size_t size);
+  void release(CgiWorker* worker, bool reusable, size_t max_requests);
+
+  static void frame(size_t len, std::string* out);
+  static int parse(std::string* in, std::string* out);
+
+ private:
+  CgiPool(const CgiPool&);
+  CgiPool& operator=(const CgiPool&);
+
+  CgiWorker* _spawn(const std::string& bin);
+  void _drop(std::list<CgiWorker>::iterator it);
+
+  std::list<CgiWorker> workers;
+};
+
+#endif  // CGIPOOL_HPP
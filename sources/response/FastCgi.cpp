@@ -0,0 +1,165 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#include "FastCgi.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+static void put_length(size_t len, std::string* out) {
+  if (len < 128) {
+    out->push_back(static_cast<char>(len));
+    return;
+  }
+  out->push_back(static_cast<char>(((len >> 24) & 0x7f) | 0x80));
+  out->push_back(static_cast<char>((len >> 16) & 0xff));
+  out->push_back(static_cast<char>((len >> 8) & 0xff));
+  out->push_back(static_cast<char>(len & 0xff));
+}
+
+void FastCgi::begin(std::string* out) {
+  char body[8] = {0, FCGI_RESPONDER, FCGI_KEEP_CONN, 0, 0, 0, 0, 0};
+
+  record(FCGI_BEGIN_REQUEST, body, sizeof(body), out);
+}
+
+void FastCgi::param(const std::string& name, const std::string& value,
+                    std::string* params) {
+  put_length(name.size(), params);
+  put_length(value.size(), params);
+  params->append(name);
+  params->append(value);
+}
+
+// a stream longer than a record can hold is split, an empty one is the
+// record that closes the stream
+void FastCgi::record(int type, const char* data, size_t len,
+                     std::string* out) {
+  do {
+    size_t chunk = (len > FCGI_MAX_CONTENT) ? FCGI_MAX_CONTENT : len;
+    size_t padding = (8 - chunk % 8) % 8;
+    char header[FCGI_HEADER_LEN] = {
+        FCGI_VERSION_1, static_cast<char>(type), 0, 1,
+        static_cast<char>((chunk >> 8) & 0xff), static_cast<char>(chunk & 0xff),
+        static_cast<char>(padding), 0};
+
+    out->append(header, FCGI_HEADER_LEN);
+    out->append(data, chunk);
+    out->append(padding, '\0');
+    data += chunk;
+    len -= chunk;
+  } while (len);
+}
+
+// consumes the complete records at the front of `in`. Returns 1 once the
+// request has ended, -1 on a record that makes no sense and 0 otherwise
+int FastCgi::parse(std::string* in, std::string* out, std::string* err) {
+  size_t pos = 0;
+  int ret = 0;
+
+  while (ret == 0 && in->size() - pos >= FCGI_HEADER_LEN) {
+    const unsigned char* h =
+        reinterpret_cast<const unsigned char*>(in->data() + pos);
+    size_t len = (h[4] << 8) | h[5];
+    size_t total = FCGI_HEADER_LEN + len + h[6];
+
+    if (h[0] != FCGI_VERSION_1) {
+      ret = -1;
+      break;
+    }
+    if (in->size() - pos < total)
+      break;
+    if (h[1] == FCGI_STDOUT)
+      out->append(*in, pos + FCGI_HEADER_LEN, len);
+    else if (h[1] == FCGI_STDERR)
+      err->append(*in, pos + FCGI_HEADER_LEN, len);
+    else if (h[1] == FCGI_END_REQUEST)
+      ret = 1;
+    pos += total;
+  }
+  in->erase(0, pos);
+  return (ret);
+}
+
+FastCgiPool::FastCgiPool(void) : keepalive(0) {}
+
+FastCgiPool::~FastCgiPool(void) {
+  std::map<std::string, std::vector<int> >::iterator it = idle.begin();
+  for (; it != idle.end(); it++)
+    for (size_t i = 0; i < it->second.size(); i++)
+      close(it->second[i]);
+}
+
+void FastCgiPool::configure(size_t _keepalive) {
+  keepalive = _keepalive;
+}
+
+int FastCgiPool::connect(const std::string& address) {
+  std::vector<int>& fds = idle[address];
+  char c;
+
+  while (fds.size()) {
+    int fd = fds.back();
+    fds.pop_back();
+    // anything but "nothing to read yet" means the backend is done with it
+    if (recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == -1 && errno == EAGAIN)
+      return (fd);
+    close(fd);
+  }
+  return (_open(address));
+}
+
+void FastCgiPool::release(const std::string& address, int fd) {
+  std::vector<int>& fds = idle[address];
+
+  if (fds.size() >= keepalive) {
+    close(fd);
+    return;
+  }
+  fds.push_back(fd);
+}
+
+// the connection is started without waiting for it, it is usable once the
+// socket reports POLLOUT
+int FastCgiPool::_open(const std::string& address) {
+  sockaddr_storage addr;
+  socklen_t len;
+  int fd;
+
+  std::memset(&addr, 0, sizeof(addr));
+  if (address.compare(0, 5, "unix:") == 0) {
+    sockaddr_un* un = reinterpret_cast<sockaddr_un*>(&addr);
+    un->sun_family = AF_UNIX;
+    std::strncpy(un->sun_path, address.c_str() + 5, sizeof(un->sun_path) - 1);
+    len = sizeof(sockaddr_un);
+  } else {
+    sockaddr_in* in = reinterpret_cast<sockaddr_in*>(&addr);
+    std::string::size_type colon = address.find(':');
+    in->sin_family = AF_INET;
+    in->sin_addr.s_addr = inet_addr(address.substr(0, colon).c_str());
+    in->sin_port = htons(std::atoi(address.c_str() + colon + 1));
+    len = sizeof(sockaddr_in);
+  }
+  fd = socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd == -1)
+    return (-1);
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), len) == -1 &&
+      errno != EINPROGRESS) {
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return (-1);
+  }
+  return (fd);
+}
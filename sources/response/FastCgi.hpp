@@ -0,0 +1,63 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#pragma once
+#ifndef FASTCGI_HPP
+#define FASTCGI_HPP
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#define FCGI_VERSION_1 1
+#define FCGI_HEADER_LEN 8
+#define FCGI_MAX_CONTENT 65535
+#define FCGI_BEGIN_REQUEST 1
+#define FCGI_END_REQUEST 3
+#define FCGI_PARAMS 4
+#define FCGI_STDIN 5
+#define FCGI_STDOUT 6
+#define FCGI_STDERR 7
+#define FCGI_RESPONDER 1
+#define FCGI_KEEP_CONN 1
+
+// Records of the FastCGI protocol. There is never more than one request on a
+// connection at a time, so every record is sent with request id 1.
+class FastCgi {
+ public:
+  static void begin(std::string* out);
+  static void param(const std::string& name, const std::string& value,
+                    std::string* params);
+  static void record(int type, const char* data, size_t len, std::string* out);
+  static int parse(std::string* in, std::string* out, std::string* err);
+};
+
+// Connections to FastCGI backends, "unix:/path" or "ip:port". A connection
+// whose request ended cleanly is kept for the next one, up to `keepalive`
+// idle connections per backend. Idle connections the backend closed in the
+// meantime are noticed and dropped when they are taken again.
+class FastCgiPool {
+ public:
+  FastCgiPool(void);
+  ~FastCgiPool(void);
+
+  void configure(size_t keepalive);
+  int connect(const std::string& address);
+  void release(const std::string& address, int fd);
+
+ private:
+  FastCgiPool(const FastCgiPool&);
+  FastCgiPool& operator=(const FastCgiPool&);
+
+  static int _open(const std::string& address);
+
+  std::map<std::string, std::vector<int> > idle;
+  size_t keepalive;
+};
+
+#endif  // FASTCGI_HPP
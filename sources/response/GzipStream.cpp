@@ -0,0 +1,47 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#include "GzipStream.hpp"
+
+#include <cstring>
+
+GzipStream::GzipStream(int level) {
+  std::memset(&zs, 0, sizeof(zs));
+  // 16 added to the window bits asks zlib for a gzip wrapper
+  ready = (deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 8,
+                        Z_DEFAULT_STRATEGY) == Z_OK);
+}
+
+GzipStream::GzipStream(const GzipStream&) { }
+
+GzipStream& GzipStream::operator=(const GzipStream&) { return *this; }
+
+GzipStream::~GzipStream(void) {
+  if (ready)
+    deflateEnd(&zs);
+}
+
+bool GzipStream::ok(void) const {
+  return (ready);
+}
+
+// appends the compressed form of `data` to `out`
+void GzipStream::compress(const char* data, size_t len, bool last,
+                          std::string* out) {
+  int ret;
+
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+  zs.avail_in = len;
+  do {
+    size_t used = out->size();
+    out->resize(used + deflateBound(&zs, zs.avail_in) + 64);
+    zs.next_out = reinterpret_cast<Bytef*>(&(*out)[used]);
+    zs.avail_out = out->size() - used;
+    ret = deflate(&zs, last ? Z_FINISH : Z_SYNC_FLUSH);
+    out->resize(out->size() - zs.avail_out);
+  } while (ret == Z_OK && (zs.avail_out == 0 || (last && ret != Z_STREAM_END)));
+}
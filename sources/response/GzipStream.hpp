@@ -0,0 +1,35 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#pragma once
+#ifndef GZIPSTREAM_HPP
+#define GZIPSTREAM_HPP
+
+#include <zlib.h>
+
+#include <cstddef>
+#include <string>
+
+// gzip encoder fed one body chunk at a time. Every chunk is flushed so what
+// has been sent so far can be decoded by the client right away.
+class GzipStream {
+ public:
+  explicit GzipStream(int level);
+  ~GzipStream(void);
+
+  bool ok(void) const;
+  void compress(const char* data, size_t len, bool last, std::string* out);
+
+ private:
+  GzipStream(const GzipStream&);
+  GzipStream& operator=(const GzipStream&);
+
+  z_stream zs;
+  bool ready;
+};
+
+#endif  // GZIPSTREAM_HPP
@@ -0,0 +1,168 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#include "OpenFileCache.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include "WebServ.hpp"
+
+OpenFileCache::OpenFileCache(void)
+    : max(DFL_OPEN_FILE_CACHE),
+      valid(DFL_OPEN_FILE_CACHE_VALID),
+      errors(DFL_OPEN_FILE_CACHE_ERRORS) { }
+
+OpenFileCache::OpenFileCache(const OpenFileCache&) { }
+
+OpenFileCache& OpenFileCache::operator=(const OpenFileCache&) {
+  return *this;
+}
+
+OpenFileCache::~OpenFileCache(void) {
+  while (files.size())
+    _evict(files.begin()->second);
+  _sweep();
+}
+
+void OpenFileCache::configure(size_t _max, size_t _valid, bool _errors) {
+  while (files.size())
+    _evict(files.begin()->second);
+  max = _max;
+  valid = _valid;
+  errors = _errors;
+}
+
+OpenFile* OpenFileCache::lookup(const std::string& path) {
+  size_t now = WebServ::get_time_in_ms();
+  OpenFile* file;
+
+  _sweep();
+  std::map<std::string, OpenFile*>::iterator it = files.find(path);
+  if (it != files.end()) {
+    file = it->second;
+    if (now - file->validated >= valid) {
+      if (!_unchanged(file)) {
+        _evict(file);
+        file = NULL;
+      } else {
+        file->validated = now;
+      }
+    }
+    if (file) {
+      recent.splice(recent.begin(), recent, file->lru);
+      return (file);
+    }
+  }
+  file = _open(path, now);
+  if (max == 0 || (file->err && !errors)) {
+    transient.push_back(file);
+    return (file);
+  }
+  file->cached = true;
+  files[path] = file;
+  recent.push_front(file);
+  file->lru = recent.begin();
+  if (files.size() > max)
+    _evict(recent.back());
+  return (file);
+}
+
+void OpenFileCache::acquire(OpenFile* file) {
+  if (!file->cached) {
+    std::vector<OpenFile*>::iterator it;
+    it = std::find(transient.begin(), transient.end(), file);
+    if (it != transient.end())
+      transient.erase(it);
+  }
+  file->refs++;
+}
+
+void OpenFileCache::release(OpenFile* file) {
+  if (file == NULL)
+    return;
+  file->refs--;
+  if (file->refs == 0 && !file->cached)
+    _destroy(file);
+}
+
+// for changes the server makes itself, which must not wait for revalidation
+void OpenFileCache::invalidate(const std::string& path) {
+  std::map<std::string, OpenFile*>::iterator it = files.find(path);
+  if (it != files.end())
+    _evict(it->second);
+}
+
+size_t OpenFileCache::size(void) const {
+  return (files.size());
+}
+
+OpenFile* OpenFileCache::_open(const std::string& path, size_t now) {
+  OpenFile* file = new OpenFile();
+  struct stat st;
+
+  file->path = path;
+  file->fd = -1;
+  file->err = 0;
+  file->mode = 0;
+  file->size = 0;
+  file->mtime = 0;
+  file->inode = 0;
+  file->validated = now;
+  file->refs = 0;
+  file->cached = false;
+  if (stat(path.c_str(), &st) == -1) {
+    file->err = errno;
+    return (file);
+  }
+  if (S_ISREG(st.st_mode)) {
+    file->fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file->fd == -1)
+      file->err = errno;
+    else
+      fstat(file->fd, &st);
+  }
+  file->mode = st.st_mode;
+  file->size = st.st_size;
+  file->mtime = st.st_mtime;
+  file->inode = st.st_ino;
+  return (file);
+}
+
+bool OpenFileCache::_unchanged(const OpenFile* file) {
+  struct stat st;
+
+  if (stat(file->path.c_str(), &st) == -1)
+    return (file->mode == 0 && file->err == errno);
+  return (file->mode == st.st_mode && file->size == st.st_size &&
+          file->mtime == st.st_mtime && file->inode == st.st_ino);
+}
+
+void OpenFileCache::_evict(OpenFile* file) {
+  files.erase(file->path);
+  recent.erase(file->lru);
+  file->cached = false;
+  if (file->refs == 0)
+    _destroy(file);
+}
+
+void OpenFileCache::_destroy(OpenFile* file) {
+  if (file->fd != -1)
+    close(file->fd);
+  delete file;
+}
+
+// transient entries (cache disabled, or an uncached miss) only live until
+// the next lookup unless a response acquired them
+void OpenFileCache::_sweep(void) {
+  for (size_t i = 0; i < transient.size(); i++)
+    _destroy(transient[i]);
+  transient.clear();
+}
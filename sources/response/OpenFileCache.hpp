@@ -0,0 +1,77 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#pragma once
+#ifndef OPENFILECACHE_HPP
+#define OPENFILECACHE_HPP
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+// What a lookup learnt about a path. `mode` is 0 when stat() failed and `err`
+// holds the errno of whichever of stat()/open() failed, so a file that exists
+// but cannot be read still reports itself as a regular file.
+struct OpenFile {
+  std::string path;
+  int fd;
+  int err;
+  mode_t mode;
+  off_t size;
+  time_t mtime;
+  ino_t inode;
+  size_t validated;
+  int refs;
+  bool cached;
+  std::list<OpenFile*>::iterator lru;
+};
+
+// Open descriptors and metadata of the files served, keyed by path. An entry
+// is trusted for `valid` ms, then a single stat() tells whether it still
+// describes the file; misses are remembered too when `errors` is on. Past
+// `max` entries the least recently used one is dropped.
+//
+// An entry returned by lookup() is only guaranteed until the next lookup:
+// a response that keeps using the descriptor must acquire() it, and release()
+// it when done. Evicted entries that are still referenced are closed on their
+// last release.
+class OpenFileCache {
+ public:
+  OpenFileCache(void);
+  ~OpenFileCache(void);
+
+  void configure(size_t max, size_t valid, bool errors);
+  OpenFile* lookup(const std::string& path);
+  void acquire(OpenFile* file);
+  void release(OpenFile* file);
+  void invalidate(const std::string& path);
+  size_t size(void) const;
+
+ private:
+  OpenFileCache(const OpenFileCache&);
+  OpenFileCache& operator=(const OpenFileCache&);
+
+  OpenFile* _open(const std::string& path, size_t now);
+  bool _unchanged(const OpenFile* file);
+  void _evict(OpenFile* file);
+  void _destroy(OpenFile* file);
+  void _sweep(void);
+
+  std::map<std::string, OpenFile*> files;
+  std::list<OpenFile*> recent;
+  std::vector<OpenFile*> transient;
+  size_t max;
+  size_t valid;
+  bool errors;
+};
+
+#endif  // OPENFILECACHE_HPP
@@ -0,0 +1,138 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#include "OutputQueue.hpp"
+
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+
+#include <cerrno>
+
+const char* OutputSegment::data(void) const {
+  return (base ? base : owned.data());
+}
+
+OutputQueue::OutputQueue(void): offset(0), bytes(0) { }
+
+OutputQueue::~OutputQueue(void) { }
+
+void OutputQueue::push(const std::string& data) {
+  push(data.data(), data.size());
+}
+
+void OutputQueue::push(const char* data, size_t len) {
+  if (len == 0)
+    return;
+  segments.push_back(OutputSegment());
+  segments.back().owned.assign(data, len);
+  segments.back().base = NULL;
+  segments.back().file = -1;
+  segments.back().len = len;
+  bytes += len;
+}
+
+void OutputQueue::push_ref(const char* data, size_t len) {
+  if (len == 0)
+    return;
+  segments.push_back(OutputSegment());
+  segments.back().base = data;
+  segments.back().file = -1;
+  segments.back().len = len;
+  bytes += len;
+}
+
+// the descriptor stays owned by the caller and must outlive the segment
+void OutputQueue::push_file(int file, off_t pos, size_t len) {
+  if (len == 0)
+    return;
+  segments.push_back(OutputSegment());
+  segments.back().base = NULL;
+  segments.back().file = file;
+  segments.back().pos = pos;
+  segments.back().len = len;
+  bytes += len;
+}
+
+// writes until the queue drains or the socket would block. Returns the
+// number of bytes written, or -1 when the connection is broken
+ssize_t OutputQueue::flush(int fd) {
+  ssize_t total = 0;
+
+  while (bytes) {
+    ssize_t written;
+    if (segments.front().file != -1)
+      written = _sendfile(fd);
+    else
+      written = _writev(fd);
+    if (written == -1) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return (total);
+      return (-1);
+    }
+    // a file that shrank after being queued can never complete
+    if (written == 0) {
+      errno = EIO;
+      return (-1);
+    }
+    _consume(written);
+    total += written;
+  }
+  return (total);
+}
+
+// gathers the memory segments up to the next file segment
+ssize_t OutputQueue::_writev(int fd) {
+  struct iovec iov[OUTPUT_IOV_MAX];
+  int count = 0;
+
+  std::deque<OutputSegment>::iterator it = segments.begin();
+  for (; it != segments.end() && count < OUTPUT_IOV_MAX; it++, count++) {
+    if (it->file != -1)
+      break;
+    size_t skip = (count == 0) ? offset : 0;
+    iov[count].iov_base = const_cast<char*>(it->data()) + skip;
+    iov[count].iov_len = it->len - skip;
+  }
+  return (writev(fd, iov, count));
+}
+
+ssize_t OutputQueue::_sendfile(int fd) {
+  OutputSegment& front = segments.front();
+  off_t pos = front.pos + offset;
+
+  return (sendfile(fd, front.file, &pos, front.len - offset));
+}
+
+void OutputQueue::_consume(size_t len) {
+  bytes -= len;
+  while (len) {
+    size_t left = segments.front().len - offset;
+    if (len < left) {
+      offset += len;
+      return;
+    }
+    len -= left;
+    segments.pop_front();
+    offset = 0;
+  }
+}
+
+void OutputQueue::clear(void) {
+  segments.clear();
+  offset = 0;
+  bytes = 0;
+}
+
+bool OutputQueue::empty(void) const {
+  return (bytes == 0);
+}
+
+size_t OutputQueue::size(void) const {
+  return (bytes);
+}
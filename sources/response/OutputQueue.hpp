@@ -0,0 +1,61 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#pragma once
+#ifndef OUTPUTQUEUE_HPP
+#define OUTPUTQUEUE_HPP
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <deque>
+#include <string>
+
+#define OUTPUT_IOV_MAX 64
+
+// A segment either owns a copy of its bytes, borrows memory that the
+// caller keeps alive until the queue has drained (a pooled body buffer), or
+// names a range of an open file that is handed to sendfile()
+struct OutputSegment {
+  std::string owned;
+  const char* base;
+  int file;
+  off_t pos;
+  size_t len;
+
+  const char* data(void) const;
+};
+
+// Bytes waiting to be written to a client, in order: the response header
+// followed by its body segments. flush() gathers as many segments as
+// possible in one writev() and remembers how far into the front segment the
+// kernel got, so a short write resumes at the exact byte on the next POLLOUT.
+class OutputQueue {
+ public:
+  OutputQueue(void);
+  ~OutputQueue(void);
+
+  void push(const std::string& data);
+  void push(const char* data, size_t len);
+  void push_ref(const char* data, size_t len);
+  void push_file(int file, off_t pos, size_t len);
+  ssize_t flush(int fd);
+  void clear(void);
+  bool empty(void) const;
+  size_t size(void) const;
+
+ private:
+  ssize_t _writev(int fd);
+  ssize_t _sendfile(int fd);
+  void _consume(size_t len);
+
+  std::deque<OutputSegment> segments;
+  size_t offset;
+  size_t bytes;
+};
+
+#endif  // OUTPUTQUEUE_HPP
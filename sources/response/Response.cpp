@@ -7,6 +7,8 @@
 
 #include "Response.hpp"
 
+#include <limits>
+
 std::ostream& operator<<(std::ostream& o, Response const& rhs) {
   o << std::setfill(' ') << " [ RESPONSE DUMP ]\n"
     << std::setw(15) << std::left << "method" << " : "
@@ -37,10 +39,6 @@ int Response::_put(void) {
   return METHOD_NOT_ALLOWED;
 }
 
-int Response::_head(void) {
-  return METHOD_NOT_ALLOWED;
-}
-
 int Response::_connect(void) {
   return METHOD_NOT_ALLOWED;
 }
@@ -58,15 +56,19 @@ int Response::_trace(void) {
 }
 
 void Response::_send(int fd) {
-  ssize_t bytes;
-  // WebServ::log.error() << ResponseBase::buffer_resp << "\n";
-  bytes = send(fd, ResponseBase::buffer_resp, ResponseBase::size, MSG_NOSIGNAL);
-  if (bytes == 0 || bytes == -1) {
+  if (out.flush(fd) == -1) {
     WebServ::log.error() << "unable to send response: "
                          << strerror(errno) << "\n";
+    out.clear();
     finished = true;
+    return;
   }
-  WebServ::log.info() << "Response sent to client " << fd << "\n";
+  if (out.empty())
+    WebServ::log.info() << "Response sent to client " << fd << "\n";
+}
+
+bool Response::pending(void) const {
+  return (!out.empty());
 }
 
 int Response::validate_limit_except(void) {
@@ -77,6 +79,9 @@ int Response::validate_limit_except(void) {
     std::vector<std::string>::iterator ite = location->limit_except.end();
     if (std::find(it, ite, method) != location->limit_except.end())
        return CONTINUE;
+    // allowing GET allows HEAD
+    if (method == "HEAD" && std::find(it, ite, "GET") != ite)
+       return CONTINUE;
     return METHOD_NOT_ALLOWED;
   }
   return CONTINUE;
@@ -88,62 +93,386 @@ int Response::validate_http_version(void) {
   return CONTINUE;
 }
 
-static std::string fetch_path2(std::string const& bin) {
-  int pid;
-  int io[2];
-  char buf[1024];
+void Response::cgi(std::string const &body_path, std::string const &bin) {
+  if (!spawn_cgi(body_path.substr(2), bin, -1))
+    fail_cgi("could not start " + bin + ": " + strerror(errno));
+}
+
+// argv and envp are built before the fork, the child only redirects its
+// stdin and stdout and calls execve on the interpreter's resolved path. Its
+// stdin is `input` (consumed), or a pipe fed from the event loop with the
+// request body as it arrives, and its output is read from another pipe.
+bool Response::spawn_cgi(std::string const& script, std::string const& bin,
+                         int input) {
+  std::vector<std::string> vars;
+  std::vector<char*> envp;
+  env_map env;
+  int out[2];
+  int in[2] = {-1, -1};
 
-  pipe(io);
+  cgi_environment(script, &env);
+  env["SCRIPT_NAME"] = bin;
+  for (env_map::iterator it = env.begin(); it != env.end(); it++)
+    vars.push_back(it->first + "=" + it->second);
+  for (size_t i = 0; i < vars.size(); i++)
+    envp.push_back(const_cast<char*>(vars[i].c_str()));
+  envp.push_back(NULL);
+  char* argv[] = {const_cast<char*>(bin.c_str()),
+                  const_cast<char*>(script.c_str()), NULL};
+  if (input == -1 && pipe2(in, O_CLOEXEC) == 0)
+    input = in[0];
+  if (input == -1)
+    return (false);
+  if (pipe2(out, O_CLOEXEC) == -1) {
+    close(input);
+    if (in[1] != -1)
+      close(in[1]);
+    return (false);
+  }
   pid = fork();
   if (pid == 0) {
-    dup2(io[1], STDOUT_FILENO);
-    execlp("which", "which", bin.c_str(), NULL);
+    dup2(input, STDIN_FILENO);
+    dup2(out[1], STDOUT_FILENO);
+    execve(argv[0], argv, &envp[0]);
+    _exit(1);
+  }
+  close(input);
+  close(out[1]);
+  if (pid == -1) {
+    close(out[0]);
+    if (in[1] != -1)
+      close(in[1]);
+    return (false);
+  }
+  track_child(pid);
+  fcntl(out[0], F_SETFL, O_NONBLOCK);
+  cgi_out = out[0];
+  cgi_output.clear();
+  this->bin = bin;
+  if (in[1] != -1) {
+    fcntl(in[1], F_SETFL, O_NONBLOCK);
+    cgi_in = in[1];
+    feed_cgi();
   }
-  close(io[1]);
-  pid = read(io[0], buf, 1024);
-  close(io[0]);
-  buf[pid] = '\0';
-  return std::string(buf);
+  return (true);
 }
 
-void Response::cgi(std::string const &body_path, std::string const &bin) {
-  int fd = open(DFL_TMPFILE, O_CREAT | O_RDWR | O_TRUNC, 0644);
-  int piper[2];
-  pipe(piper);
-  if (fd == -1)
-    throw(std::exception());
-  int status;
-  // WebServ::log.error() << body_path.c_str() << "\n";
-  int pid = fork();
-  if (pid == 0) {
-    dup2(piper[0], STDIN_FILENO);
-    close(piper[1]);
-    setenv("SERVER_PORT", _itoa(server->port).c_str(), 1);
-    setenv("SERVER_PROTOCOL", "HTTP/1.1", 1);
-    if (req->headers.count("Cookie"))
-      setenv("HTTP_COOKIE", req->headers.at("Cookie").c_str(), 1);
-    setenv("REDIRECT_STATUS", "200", 1);
-    setenv("HTTP_HOST", req->headers.at("Host").c_str(), 1);
-    setenv("REQUEST_METHOD", "GET", 1);
-    setenv("PATH_INFO", req->path.c_str(), 1);
-    setenv("SCRIPT_NAME", fetch_path2(bin).c_str(), 1);
-    setenv("SCRIPT_FILENAME", body_path.substr(2).c_str(), 1);
-    setenv("REQUEST_URI", req->path.c_str(), 1);
-    setenv("REDIRECT_STATUS", "true", 1);
-    if (!url_parameters.empty())
-      setenv("QUERY_STRING", url_parameters.substr(1).c_str(), 1);
-    if (dup2(fd, STDOUT_FILENO) == -1) {
-      perror("dup2");
-      exit(1);
+// writes as much of the body as the child's stdin pipe takes. A child that
+// closed its input gets no more of it.
+void Response::feed_cgi(void) {
+  ssize_t n;
+
+  while (cgi_in != -1 && !body_in.empty()) {
+    n = write(cgi_in, body_in.data(), body_in.size());
+    if (n > 0)
+      body_in.erase(0, n);
+    else if (n == -1 && errno == EINTR)
+      continue;
+    else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return;
+    else {
+      body_in.clear();
+      body_dropped = true;
+    }
+  }
+}
+
+int Response::cgi_input_fd(void) const {
+  return (cgi_in);
+}
+
+short Response::cgi_input_events(void) const {
+  return (body_in.empty() ? 0 : POLLOUT);
+}
+
+// more of the body can be read from the client
+bool Response::wants_body(void) const {
+  return (cgi_in != -1 && body_in.empty() && !body_dropped);
+}
+
+// the child has all of the body, or wants none of it any more
+bool Response::input_done(void) const {
+  return (body_in.empty() &&
+          (body_dropped || parser == NULL || parser->finished));
+}
+
+// the child sees the end of its input
+void Response::close_input(void) {
+  if (cgi_in != -1)
+    close(cgi_in);
+  cgi_in = -1;
+}
+
+// a client gone before its CGI is done takes the child down with it, unless
+// it was already reaped. A FastCGI connection or a pooled worker left
+// mid-request is of no use to anyone either.
+void Response::stop_cgi(void) {
+  close_input();
+  if (upstream_body != -1)
+    close(upstream_body);
+  upstream_body = -1;
+  if (worker != NULL) {
+    WebServ::cgi_pool.release(worker, false, 0);
+  } else if (cgi_out != -1) {
+    close(cgi_out);
+    if (fastcgi_addr.empty())
+      kill_child(pid);
+  }
+  worker = NULL;
+  cgi_out = -1;
+  fastcgi_addr.clear();
+}
+
+bool Response::has_upstream(void) const {
+  return (worker != NULL || !fastcgi_addr.empty());
+}
+
+// the request goes to an idle worker of the pool of `extension` as an
+// environment frame and a body frame, false when none is free. The body is
+// read from `input`, or was buffered in memory without one.
+bool Response::pooled(std::string const& script, std::string const& extension,
+                      int input) {
+  std::pair<int, int> limits = server->cgi_pool[extension];
+  env_map env;
+  struct stat st;
+
+  worker = WebServ::cgi_pool.acquire(server->cgi[extension], limits.first);
+  if (worker == NULL)
+    return (false);
+  worker_requests = limits.second;
+  cgi_environment(script, &env);
+  std::string vars;
+  for (env_map::iterator it = env.begin(); it != env.end(); it++) {
+    vars.append(it->first + "=" + it->second);
+    vars.push_back('\0');
+  }
+  upstream.clear();
+  upstream_sent = 0;
+  CgiPool::frame(vars.size(), &upstream);
+  upstream.append(vars);
+  if (input == -1) {
+    CgiPool::frame(body_in.size(), &upstream);
+    upstream.append(body_in);
+    body_in.clear();
+  } else {
+    CgiPool::frame(fstat(input, &st) == 0 ? st.st_size : 0, &upstream);
+  }
+  upstream_body = input;
+  upstream_in.clear();
+  upstream_done = false;
+  cgi_out = worker->fd;
+  cgi_output.clear();
+  return (true);
+}
+
+// the request goes out as FastCGI records, the body is read from `input`
+// as the connection takes it, or was buffered in memory without one
+bool Response::fastcgi(std::string const& script, std::string const& address,
+                       int input) {
+  env_map env;
+  std::string params;
+  char* cwd = getcwd(NULL, 0);
+
+  cgi_environment((cwd ? std::string(cwd) + "/" : "") + script, &env);
+  free(cwd);
+  cgi_out = WebServ::fastcgi.connect(address);
+  if (cgi_out == -1) {
+    WebServ::log.error() << "fastcgi: " << address << ": "
+                         << strerror(errno) << "\n";
+    if (input != -1)
+      close(input);
+    return (false);
+  }
+  for (env_map::iterator it = env.begin(); it != env.end(); it++)
+    FastCgi::param(it->first, it->second, &params);
+  upstream.clear();
+  upstream_sent = 0;
+  FastCgi::begin(&upstream);
+  FastCgi::record(FCGI_PARAMS, params.data(), params.size(), &upstream);
+  FastCgi::record(FCGI_PARAMS, NULL, 0, &upstream);
+  upstream_body = input;
+  if (input == -1) {
+    if (body_in.size())
+      FastCgi::record(FCGI_STDIN, body_in.data(), body_in.size(), &upstream);
+    FastCgi::record(FCGI_STDIN, NULL, 0, &upstream);
+    body_in.clear();
+  }
+  upstream_in.clear();
+  upstream_done = false;
+  fastcgi_addr = address;
+  cgi_output.clear();
+  return (true);
+}
+
+// writes the request, then reads the reply until it is complete. The body
+// goes out as STDIN records to a FastCGI backend and as it is to a worker,
+// whose body frame announced its size.
+bool Response::upstream_io(void) {
+  char* buf = body_buffer();
+  std::string errors;
+  ssize_t n;
+
+  while (upstream_sent < upstream.size() || upstream_body != -1) {
+    if (upstream_sent == upstream.size()) {
+      upstream.clear();
+      upstream_sent = 0;
+      n = read(upstream_body, buf, BUFFER_SIZE);
+      if (n > 0 && worker != NULL)
+        upstream.append(buf, n);
+      if (n > 0 && worker == NULL)
+        FastCgi::record(FCGI_STDIN, buf, n, &upstream);
+      if (n > 0)
+        continue;
+      close(upstream_body);
+      upstream_body = -1;
+      if (worker == NULL)
+        FastCgi::record(FCGI_STDIN, NULL, 0, &upstream);
+      continue;
+    }
+    n = send(cgi_out, upstream.data() + upstream_sent,
+             upstream.size() - upstream_sent, MSG_NOSIGNAL);
+    if (n > 0)
+      upstream_sent += n;
+    else if (n == -1 && errno == EINTR)
+      continue;
+    else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return (false);
+    else {
+      WebServ::log.error() << "cgi: " << strerror(errno) << "\n";
+      return (true);
     }
-    // WebServ::log.error() << body_path << "\n";
-    execlp(bin.c_str(), bin.c_str(), body_path.substr(2).c_str(), NULL);
   }
-  close(piper[0]);
-  close(piper[1]);
-  waitpid(pid, &status, 0);
-  close(fd);
-  assemble_cgi(DFL_TMPFILE);
+  while (true) {
+    n = recv(cgi_out, buf, BUFFER_SIZE, 0);
+    if (n > 0) {
+      upstream_in.append(buf, n);
+      int status = (worker != NULL)
+                       ? CgiPool::parse(&upstream_in, &cgi_output)
+                       : FastCgi::parse(&upstream_in, &cgi_output, &errors);
+      if (errors.size())
+        WebServ::log.warning() << "fastcgi: " << errors;
+      errors.clear();
+      if (status == 0)
+        return (false);
+      upstream_done = (status == 1);
+      return (true);
+    }
+    if (n == -1 && errno == EINTR)
+      continue;
+    if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return (false);
+    if (n == -1)
+      WebServ::log.error() << "cgi: " << strerror(errno) << "\n";
+    return (true);
+  }
+}
+
+void Response::fail_cgi(std::string const& reason) {
+  WebServ::log.error() << "cgi: " << reason << "\n";
+  response_code = BAD_GATEWAY;
+  set_statuscode(response_code);
+  dispatch(response_path);
+}
+
+int Response::cgi_fd(void) const {
+  return (cgi_out);
+}
+
+short Response::cgi_events(void) const {
+  if (has_upstream() &&
+      (upstream_sent < upstream.size() || upstream_body != -1))
+    return (POLLOUT);
+  return (POLLIN);
+}
+
+// the end of the header block a CGI writes before its body, npos while its
+// blank line has not arrived
+static size_t header_end(std::string const& output) {
+  size_t pos = 0;
+  size_t eol;
+
+  while ((eol = output.find('\n', pos)) != std::string::npos) {
+    if (eol == pos || (eol == pos + 1 && output[pos] == '\r'))
+      return (eol + 1);
+    pos = eol + 1;
+  }
+  return (std::string::npos);
+}
+
+// reads what the child wrote so far and passes it on as soon as its header
+// is complete, true once there is nothing left. One read per call, the
+// descriptor is level-triggered and is not watched while the client lags.
+bool Response::cgi_io(void) {
+  char* buf = body_buffer();
+  bool done;
+  ssize_t n;
+
+  if (has_upstream()) {
+    done = upstream_io();
+  } else {
+    feed_cgi();
+    n = read(cgi_out, buf, BUFFER_SIZE);
+    if (n > 0)
+      cgi_output.append(buf, n);
+    done = (n == 0 || (n == -1 && errno != EINTR && errno != EAGAIN &&
+                       errno != EWOULDBLOCK));
+    if (n == -1 && done)
+      WebServ::log.error() << "cgi: " << strerror(errno) << "\n";
+  }
+  if (done)
+    return (true);
+  if (!cgi_header) {
+    size_t end = header_end(cgi_output);
+    if (end == std::string::npos)
+      return (cgi_output.size() > DFL_CGI_HEADER_MAX);
+    assemble_cgi(end);
+  }
+  forward_cgi(false);
+  return (false);
+}
+
+void Response::finish_cgi(void) {
+  std::string source(fastcgi_addr.empty() ? bin : fastcgi_addr);
+  bool complete = !has_upstream() || upstream_done;
+  size_t end = cgi_header ? 0 : header_end(cgi_output);
+
+  if (worker != NULL)
+    source = worker->bin;
+  if (end == std::string::npos && cgi_output.size() > DFL_CGI_HEADER_MAX) {
+    stop_cgi();
+    release_body();
+    fail_cgi("header too long from " + source);
+    return;
+  }
+  if (worker != NULL)
+    WebServ::cgi_pool.release(worker, upstream_done, worker_requests);
+  else if (!fastcgi_addr.empty() && upstream_done)
+    WebServ::fastcgi.release(fastcgi_addr, cgi_out);
+  else
+    close(cgi_out);
+  worker = NULL;
+  cgi_out = -1;
+  fastcgi_addr.clear();
+  close_input();
+  release_body();
+  // whatever is left of the request body can't be told from the next one
+  if (parser != NULL && !parser->finished)
+    keep_alive = false;
+  if (!cgi_header && cgi_output.empty()) {
+    fail_cgi("no output from " + source);
+    return;
+  }
+  if (!cgi_header)
+    assemble_cgi(end == std::string::npos ? cgi_output.size() : end);
+  finished = true;
+  // a body cut short can only be told apart by closing the connection
+  if (!complete || (gzip == NULL && cgi_left > 0 &&
+                    static_cast<size_t>(cgi_left) > cgi_output.size())) {
+    keep_alive = false;
+    forward_cgi(false);
+    return;
+  }
+  forward_cgi(true);
 }
 
 void Response::dispatch(std::string const& body_path) {
@@ -160,18 +489,21 @@ void Response::dispatch(std::string const& body_path) {
     extension = "text";
   else
     extension = tmp.substr(tmp.find_last_of('.'));
-  if (location->cgi.count(extension)) {
+  if (location->fastcgi_pass.count(extension)) {
+    contenttype = "Content-Type: text/html; charset=utf-8\n";
+    if (!fastcgi(body_path.substr(2), location->fastcgi_pass[extension], -1))
+      fail_cgi("no connection to " + location->fastcgi_pass[extension]);
+  }
+  else if (location->cgi.count(extension)) {
     // WebServ::log.error() << "here\n";
     contenttype = "Content-Type: text/html; charset=utf-8\n";
-    cgi(body_path, location->cgi[extension]);
+    if (!server->cgi_pool.count(extension) ||
+        !pooled(body_path.substr(2), extension, -1))
+      cgi(body_path, location->cgi[extension]);
   }
   else if (mimetypes.count(extension)) {
-    if (response_path == DFL_TMPFILE)
-      assemble_cgi(body_path);
-    else {
-      contenttype = mimetypes[extension];
-      assemble(body_path);
-    }
+    contenttype = mimetypes[extension];
+    assemble(body_path);
   }
   else {
     WebServ::log.warning() << extension << " support not yet implemented\n";
@@ -213,6 +545,9 @@ void Response::set_statuscode(int code) {
     else
       create_error_page();
   }
+  else if (response_code == NOT_MODIFIED) {
+    return;
+  }
   else if (response_code >= MOVED_PERMANENTLY) {
     if (server->error_page.count(response_code))
       response_path = server->root + "/" + server->error_page[response_code];
@@ -221,89 +556,637 @@ void Response::set_statuscode(int code) {
   }
 }
 
+// the body is read straight into a pooled buffer the output queue borrows,
+// a chunk is only read once the previous one has been written out
+char* Response::body_buffer(void) {
+  if (body == NULL)
+    body = pool.acquire();
+  return (body);
+}
+
+void Response::release_body(void) {
+  pool.release(body);
+  body = NULL;
+}
+
 void Response::assemble_followup(void) {
-  char buf[BUFFER_SIZE];
+  char* buf = body_buffer();
   size_t body_size;
-  std::string str;
 
+  if (!parts.empty()) {
+    assemble_parts();
+    return;
+  }
   file.read(buf, BUFFER_SIZE);
   body_size = file.gcount();
   if (body_size < BUFFER_SIZE || file.eof())
     finished = true;
-
-  std::memmove(&ResponseBase::buffer_resp[str.size()], buf, body_size);
-  ResponseBase::size = body_size;
-  ResponseBase::buffer_resp[ResponseBase::size] = '\0';
+  push_body(buf, body_size, finished);
 }
 
 void Response::assemble(void) {
-  std::string str(httpversion + statuscode + statusmsg + contenttype);
+  std::string str(httpversion + statuscode + statusmsg + persistence());
+  str.append(contenttype);
   str.append(DFL_CONTENTLEN);
   str.replace(str.find("LENGTH"), 6, _itoa(0));
-  std::memmove(ResponseBase::buffer_resp, str.c_str(), str.size());
-  ResponseBase::size = str.size();
-  ResponseBase::buffer_resp[ResponseBase::size] = '\0';
-  // WebServ::log.debug() << ResponseBase::buffer_resp;
+  out.push(str);
   WebServ::log.debug() << *this;
 }
 
-void Response::assemble_cgi(std::string const& body_path) {
-  std::string       body;
-  size_t            body_size = 0;
-
-  // WebServ::log.debug() << "File requested: " << path << "\n";
-  // WebServ::log.debug() << "Body path: " << body_path << "\n";
-  file.close();
-  file.open(body_path.c_str(), std::ios::binary);
-  if (file.bad() || file.fail())
-    WebServ::log.error() << "file opening in Response::assemble\n";
-
-  std::string str(httpversion + statuscode + statusmsg);
+// the header lines of the child, the first `end` bytes of its output, are
+// merged into ours. Its body follows as it arrives, as is when it announced
+// a Content-Length and in chunks otherwise.
+void Response::assemble_cgi(size_t end) {
+  std::string str(httpversion + statuscode + statusmsg + persistence());
   if (incorrect_path) {
     // req->path[req->path.size() - 1] != '/';
     str.append("Location: " + req->path + "/\n");
   }
-  std::string header;
-  std::getline(file, header);
-  // WebServ::log.warning() << "Header: " << header << "\n";
-  while (header.size() && header[0] != '\r' && header[1] != '\n') {
+  std::string type(contenttype);
+  bool encoded = false;
+  size_t pos = 0;
+  size_t eol;
+  cgi_left = -1;
+  while (pos < end &&
+         (eol = cgi_output.find('\n', pos)) != std::string::npos) {
+    std::string header(cgi_output.substr(pos, eol - pos));
+    pos = eol + 1;
+    if (header.empty() || header == "\r")
+      break;
+    std::string name(String::to_lower(header.substr(0, header.find(':'))));
+    if (name == "content-type")
+      type = header;
+    else if (name == "content-encoding")
+      encoded = true;
+    // the framing of the body is ours to choose
+    if (name == "content-length" && header.find(':') != std::string::npos)
+      cgi_left = std::strtol(header.c_str() + header.find(':') + 1, NULL, 10);
+    if (name == "content-length" || name == "transfer-encoding")
+      continue;
     str.append(header);
     if (header.find("Status") != std::string::npos) {
       str.replace(str.find("200 "), 4, header.substr(8, 4));
-
     }
     str.push_back('\n');
-    std::getline(file, header);
-    // WebServ::log.warning() << "Header: " << header << "\n";
   }
+  cgi_output.erase(0, end);
+  cgi_header = true;
+  if (cgi_left < 0)
+    cgi_left = -1;
+  if (location->gzip && response_code == OK)
+    str.append("Vary: Accept-Encoding\n");
+  if (!encoded && response_code == OK &&
+      compressible(type, cgi_left == -1 ? location->gzip_min_length
+                                        : static_cast<size_t>(cgi_left)))
+    gzip = new GzipStream(location->gzip_comp_level);
+  if (gzip != NULL && gzip->ok()) {
+    str.append(DFL_GZIPCHUNKED);
+  } else if (cgi_left != -1) {
+    delete gzip;
+    gzip = NULL;
+    str.append(DFL_CONTENTLEN);
+    str.replace(str.find("LENGTH"), 6, _itoa(cgi_left));
+  } else {
+    delete gzip;
+    gzip = NULL;
+    chunked = true;
+    str.append(DFL_CHUNKED);
+  }
+  out.push(str);
+  WebServ::log.debug() << *this;
+}
 
-  std::streampos current = file.tellg();
-  file.seekg(0, std::ios::end);
-  body_max_size = file.tellg() - current;
-  // WebServ::log.warning() << body_max_size << "\n";
-  file.seekg(current);
+// passes on what the child wrote since the last call. Past an announced
+// length the output is dropped, the client would take it for a response.
+void Response::forward_cgi(bool last) {
+  size_t len = cgi_output.size();
 
-  char buf[BUFFER_SIZE];
-  file.read(buf, BUFFER_SIZE);
-  body_size = file.gcount();
-  if (body_max_size < BUFFER_SIZE)
-    finished = true;
-  else
-    inprogress = true;
+  if (method == "HEAD") {
+    cgi_output.clear();
+    return;
+  }
+  if (gzip == NULL && !chunked) {
+    len = std::min(len, static_cast<size_t>(cgi_left));
+    out.push(cgi_output.data(), len);
+    cgi_left -= len;
+  } else {
+    push_body(cgi_output.data(), len, last);
+  }
+  cgi_output.clear();
+}
+
+// the date format of Last-Modified and If-Modified-Since
+static std::string http_date(time_t time) {
+  char buf[64];
+
+  std::strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT",
+                std::gmtime(&time));
+  return (buf);
+}
+
+// validators of the file served: the ETag changes with any of its inode,
+// size and mtime, so a replaced file never matches an old tag. A .br or .gz
+// file sent in its place is another representation and gets its own tag.
+void Response::set_validators(OpenFile* file, std::string const& coding) {
+  std::stringstream ss;
+
+  ss << std::hex << '"' << file->inode << '-' << file->size << '-'
+     << file->mtime;
+  if (coding.size())
+    ss << '-' << coding;
+  ss << '"';
+  etag = ss.str();
+  last_modified = http_date(file->mtime);
+}
+
+// HTTP/1.1 connections stay open unless the client asks otherwise, up to
+// keepalive_requests requests. After a malformed request the stream can't
+// be trusted to start at the next one
+bool Response::persistent(void) const {
+  std::map<std::string, std::string>::const_iterator it;
+  bool keep = (req->http_version == "HTTP/1.1");
+
+  if (req->error || server->keepalive_timeout == 0 ||
+      served + 1 >= static_cast<size_t>(server->keepalive_requests))
+    return (false);
+  it = req->headers.find("Connection");
+  if (it == req->headers.end())
+    return (keep);
+  std::vector<std::string> list = String::split(it->second, ",");
+  for (size_t i = 0; i < list.size(); i++) {
+    std::string token(String::to_lower(String::trim(list[i], " \t")));
+    if (token == "close")
+      return (false);
+    if (token == "keep-alive")
+      keep = true;
+  }
+  return (keep);
+}
+
+// a body still on its way in can't be skipped, so answering before the
+// whole request was read also ends the connection
+std::string Response::persistence(void) {
+  if (keep_alive && parser != NULL && !parser->finished)
+    keep_alive = false;
+  if (!keep_alive)
+    return ("Connection: close\n");
+  return ("Connection: keep-alive\nKeep-Alive: timeout=" +
+          _itoa(server->keepalive_timeout / 1000) + ", max=" +
+          _itoa(server->keepalive_requests - served - 1) + "\n");
+}
+
+// expires with a time: the Expires date follows the time of the response,
+// so it is rendered for each one and kept out of cached responses
+std::string Response::expires(void) const {
+  if (!location->expires_relative || response_code >= BAD_REQUEST)
+    return ("");
+  return ("Expires: " + http_date(std::time(NULL) + location->expires_in) +
+          "\n");
+}
+
+// status line and headers of a response with a body of `length` bytes
+std::string Response::header(size_t length) {
+  return (httpversion + statuscode + statusmsg + persistence() + expires() +
+          fields(length));
+}
+
+// the headers following the status line, Connection excepted
+std::string Response::fields(size_t length) {
+  std::string str(contenttype);
+
+  if (incorrect_path)
+    str.append("Location: " + req->path + "/\n");
+  str.append(extra_headers);
+  // expires and add_header only apply to successful responses
+  if (response_code < BAD_REQUEST)
+    str.append(location->headers);
+  if (gzip != NULL)
+    return (str.append(DFL_GZIPCHUNKED));
   str.append(DFL_CONTENTLEN);
-  str.replace(str.find("LENGTH"), 6, _itoa(body_max_size));
-  std::memmove(ResponseBase::buffer_resp, str.c_str(), str.size());
-  std::memmove(&ResponseBase::buffer_resp[str.size()], buf, body_size);
-  ResponseBase::size = str.size() + body_size;
-  ResponseBase::buffer_resp[ResponseBase::size] = '\0';
-  // WebServ::log.error() << ResponseBase::buffer_resp;
-  remove_tmp = true;
+  str.replace(str.find("LENGTH"), 6, _itoa(length));
+  return (str);
+}
+
+// the media type of a Content-Type header line, without its parameters
+static std::string media_type(std::string const& line) {
+  size_t start = line.find(':');
+
+  start = (start == std::string::npos) ? 0 : start + 1;
+  start = line.find_first_not_of(" \t", start);
+  if (start == std::string::npos)
+    return ("");
+  size_t end = line.find_first_of("; \t\r\n", start);
+  return (String::to_lower(line.substr(start, end - start)));
+}
+
+// gzip: bodies of the types listed in gzip_types are compressed on the fly
+// for clients that accept it, unless they are shorter than gzip_min_length
+bool Response::compressible(std::string const& type, size_t length) const {
+  if (!location->gzip ||
+      length < static_cast<size_t>(location->gzip_min_length) ||
+      !accepts_encoding("gzip"))
+    return (false);
+  std::string name(media_type(type));
+  for (size_t i = 0; i < location->gzip_types.size(); i++) {
+    if (location->gzip_types[i] == "*" || location->gzip_types[i] == name)
+      return (true);
+  }
+  return (false);
+}
+
+// a compressed body goes out chunked since its length is only known once
+// the last chunk went through the encoder, which then also ends the stream.
+// So does the output of a CGI that did not announce its length.
+void Response::push_body(const char* data, size_t len, bool last) {
+  if (gzip == NULL && !chunked) {
+    out.push_ref(data, len);
+    return;
+  }
+  std::string chunk;
+  if (gzip != NULL)
+    gzip->compress(data, len, last, &chunk);
+  else
+    chunk.assign(data, len);
+  if (chunk.size()) {
+    std::stringstream ss;
+    ss << std::hex << chunk.size() << "\r\n";
+    out.push(ss.str());
+    chunk.append("\r\n");
+    out.push(chunk);
+  }
+  if (last)
+    out.push("0\r\n\r\n");
+}
+
+bool Response::accepts_encoding(std::string const& coding) const {
+  std::map<std::string, std::string>::const_iterator it;
+  double wildcard = 0;
+
+  it = req->headers.find("Accept-Encoding");
+  if (it == req->headers.end())
+    return (false);
+  std::vector<std::string> list = String::split(it->second, ",");
+  for (size_t i = 0; i < list.size(); i++) {
+    std::string name = String::trim(list[i].substr(0, list[i].find(';')), " ");
+    double q = 1;
+    size_t pos = list[i].find("q=");
+    if (pos != std::string::npos)
+      q = std::strtod(list[i].c_str() + pos + 2, NULL);
+    if (name == coding)
+      return (q > 0);
+    if (name == "*")
+      wildcard = q;
+  }
+  return (wildcard > 0);
+}
+
+static const char* static_codings[] = {"br", "gzip"};
+static const char* static_suffixes[] = {".br", ".gz"};
+
+// gzip_static and brotli_static: the coding of a .br or .gz file lying next
+// to `body_path` that the client accepts, empty when there is none
+std::string Response::static_coding(std::string const& body_path) const {
+  int enabled[] = {location->brotli_static, location->gzip_static};
+
+  for (size_t i = 0; i < 2; i++) {
+    if (!enabled[i] || !accepts_encoding(static_codings[i]))
+      continue;
+    OpenFile* file = WebServ::open_files.lookup(body_path + static_suffixes[i]);
+    if (file->err || !S_ISREG(file->mode))
+      continue;
+    return (static_codings[i]);
+  }
+  return ("");
+}
+
+// that file is sent in place of the one requested
+std::string Response::select_variant(std::string const& body_path) {
+  if (response_code != OK || body_path == DFL_DYNFILE ||
+      (!location->brotli_static && !location->gzip_static &&
+       !location->gzip))
+    return (body_path);
+  extra_headers.append("Vary: Accept-Encoding\n");
+  std::string coding(static_coding(body_path));
+  if (coding.empty())
+    return (body_path);
+  extra_headers.append("Content-Encoding: " + coding + "\n");
+  return (body_path + (coding == "br" ? ".br" : ".gz"));
+}
+
+// small files are answered from a response serialized once and kept whole,
+// a hit is a single queued block. A gzip compressed copy is cached apart
+// from the identity one and is only built once per version of the file.
+// HEAD is answered with the headers of the entry, so with the same length
+bool Response::assemble_cached(std::string const& body_path, bool compress) {
+  ResponseCache& cache = WebServ::response_cache;
+  CachedResponse* entry;
+  OpenFile* file;
+
+  if (response_code != OK || incorrect_path || body_path == DFL_DYNFILE)
+    return (false);
+  file = WebServ::open_files.lookup(body_path);
+  if (!cache.cacheable(file))
+    return (false);
+  // the same file may be sent with different headers
+  std::string key(body_path + "\n" + contenttype + extra_headers +
+                  location->headers);
+  if (compress)
+    key.append("gzip\n");
+  entry = cache.find(key, file);
+  if (entry == NULL) {
+    std::string content(file->size, '\0');
+    if (file->size &&
+        pread(file->fd, &content[0], file->size, 0) != file->size)
+      return (false);
+    if (compress) {
+      GzipStream encoder(location->gzip_comp_level);
+      std::string packed;
+      if (!encoder.ok())
+        return (false);
+      encoder.compress(content.data(), content.size(), true, &packed);
+      content.swap(packed);
+      extra_headers.append("Content-Encoding: gzip\n");
+    }
+    std::string data(httpversion + statuscode + statusmsg);
+    data.append(fields(content.size()));
+    data.append(content);
+    entry = cache.insert(key, file, &data);
+  }
+  cache.acquire(entry);
+  cached = entry;
+  // the Connection and Expires headers depend on the request, they go in
+  // between
+  size_t status = entry->data.find('\n') + 1;
+  size_t end = entry->data.size();
+  if (method == "HEAD")
+    end = entry->data.find("\n\n", status) + 2;
+  out.push_ref(entry->data.data(), status);
+  out.push(persistence() + expires());
+  out.push_ref(entry->data.data() + status, end - status);
+  finished = true;
+  return (true);
+}
+
+// only the header goes through userspace, the body is queued as a file
+// segment the kernel copies straight to the socket. Generated pages are
+// excluded, their file is rewritten by the next request that needs one
+bool Response::assemble_sendfile(std::string const& body_path) {
+  OpenFile* file;
+
+  if (!location->sendfile || body_path == DFL_DYNFILE)
+    return (false);
+  file = WebServ::open_files.lookup(body_path);
+  if (file->fd == -1)
+    return (false);
+  WebServ::open_files.acquire(file);
+  body_file = file;
+  body_max_size = file->size;
+  out.push(header(body_max_size));
+  out.push_file(body_file->fd, 0, body_max_size);
+  finished = true;
   WebServ::log.debug() << *this;
+  return (true);
+}
+
+// a position of a byte range, false when it does not fit an off_t
+static bool parse_offset(std::string const& digits, off_t* offset) {
+  unsigned long value;
+
+  errno = 0;
+  value = std::strtoul(digits.c_str(), NULL, 10);
+  if (errno == ERANGE ||
+      value > static_cast<unsigned long>(std::numeric_limits<off_t>::max()))
+    return (false);
+  *offset = value;
+  return (true);
 }
 
-void Response::assemble(std::string const& body_path) {
+// Range: bytes=0-99,200-,-50. Returns false when the header has to be
+// ignored, as it is for positions too large to be ones, ranges starting
+// past the end are left out
+static bool parse_ranges(std::string const& value, off_t size,
+                         std::vector<std::pair<off_t, off_t> >* ranges) {
+  if (value.compare(0, 6, "bytes=") != 0)
+    return (false);
+  std::vector<std::string> list = String::split(value.substr(6), ",");
+  if (list.empty() || list.size() > DFL_MAX_RANGES)
+    return (false);
+  for (size_t i = 0; i < list.size(); i++) {
+    std::string spec(String::trim(list[i], " \t"));
+    size_t dash = spec.find('-');
+    if (dash == std::string::npos ||
+        spec.find_first_not_of("0123456789-") != std::string::npos ||
+        spec.find('-', dash + 1) != std::string::npos)
+      return (false);
+    std::string first(spec.substr(0, dash));
+    std::string last(spec.substr(dash + 1));
+    off_t start;
+    off_t end = size - 1;
+    if (first.empty()) {
+      if (last.empty())
+        return (false);
+      off_t suffix;
+      if (!parse_offset(last, &suffix))
+        return (false);
+      if (suffix == 0)
+        continue;
+      start = (suffix < size) ? size - suffix : 0;
+    } else {
+      if (!parse_offset(first, &start))
+        return (false);
+      if (!last.empty()) {
+        off_t stop;
+        if (!parse_offset(last, &stop) || stop < start)
+          return (false);
+        end = std::min(stop, end);
+      }
+    }
+    if (start < size)
+      ranges->push_back(std::make_pair(start, end));
+  }
+  return (true);
+}
+
+// If-Range: the ranges are only sent if the file is still the version the
+// client has part of, the whole file is sent otherwise
+bool Response::range_applies(OpenFile* file) const {
+  std::map<std::string, std::string>::const_iterator it;
+
+  it = req->headers.find("If-Range");
+  if (it == req->headers.end())
+    return (true);
+  if (it->second[0] == '"')
+    return (it->second == etag);
+  return (it->second == http_date(file->mtime));
+}
+
+// Range: the requested stretches are sent by offset, a single one as the
+// body itself, several as a multipart/byteranges body
+bool Response::assemble_ranges(std::string const& body_path) {
+  std::vector<std::pair<off_t, off_t> > ranges;
+  OpenFile* file;
+
+  if (method != "GET" || response_code != OK || incorrect_path ||
+      body_path == DFL_DYNFILE || !req->headers.count("Range"))
+    return (false);
+  file = WebServ::open_files.lookup(body_path);
+  if (file->fd == -1 || !range_applies(file) ||
+      !parse_ranges(req->headers["Range"], file->size, &ranges))
+    return (false);
+  WebServ::open_files.acquire(file);
+  body_file = file;
+  std::string total(_itoa(file->size));
+  if (ranges.empty()) {
+    response_code = REQUESTED_RANGE_NOT_SATISFIABLE;
+    statuscode = _itoa(response_code) + " ";
+    statusmsg = statuslist[response_code];
+    extra_headers.append("Content-Range: bytes */" + total + "\n");
+    out.push(header(0));
+    finished = true;
+    return (true);
+  }
+  response_code = PARTIAL_CONTENT;
+  statuscode = _itoa(response_code) + " ";
+  statusmsg = statuslist[response_code];
+  body_max_size = 0;
+  if (ranges.size() == 1) {
+    size_t len = ranges[0].second - ranges[0].first + 1;
+    FilePart part = {"", ranges[0].first, len};
+    extra_headers.append("Content-Range: bytes " + _itoa(ranges[0].first) +
+                         "-" + _itoa(ranges[0].second) + "/" + total + "\n");
+    parts.push_back(part);
+    body_max_size = part.len;
+  } else {
+    std::string boundary(DFL_SEPARATOR, sizeof(DFL_SEPARATOR) - 2);
+    std::string type(contenttype.substr(0, contenttype.size() - 1) + "\r\n");
+    for (size_t i = 0; i < ranges.size(); i++) {
+      size_t len = ranges[i].second - ranges[i].first + 1;
+      FilePart part = {"\r\n--" + boundary + "\r\n" + type +
+                       "Content-Range: bytes " + _itoa(ranges[i].first) + "-" +
+                       _itoa(ranges[i].second) + "/" + total + "\r\n\r\n",
+                       ranges[i].first, len};
+      parts.push_back(part);
+      body_max_size += part.head.size() + part.len;
+    }
+    FilePart closing = {"\r\n--" + boundary + "--\r\n", 0, 0};
+    parts.push_back(closing);
+    body_max_size += closing.head.size();
+    contenttype = MULTIPART;
+  }
+  out.push(header(body_max_size));
+  assemble_parts();
+  WebServ::log.debug() << *this;
+  return (true);
+}
+
+// with sendfile every part is queued at once, otherwise one pooled buffer
+// is read at the part's offset each time the previous one went out
+void Response::assemble_parts(void) {
+  while (!parts.empty()) {
+    FilePart& part = parts.front();
+    if (part.head.size()) {
+      out.push(part.head);
+      part.head.clear();
+    }
+    if (part.len && location->sendfile) {
+      out.push_file(body_file->fd, part.pos, part.len);
+      part.len = 0;
+    }
+    if (part.len == 0) {
+      parts.pop_front();
+      continue;
+    }
+    char* buf = body_buffer();
+    ssize_t size = pread(body_file->fd, buf,
+                         std::min(part.len, static_cast<size_t>(BUFFER_SIZE)),
+                         part.pos);
+    if (size <= 0) {
+      WebServ::log.error() << "unable to read " << path << "\n";
+      // the body falls short of its announced length
+      keep_alive = false;
+      parts.clear();
+      break;
+    }
+    out.push_ref(buf, size);
+    part.pos += size;
+    part.len -= size;
+    if (part.len == 0)
+      parts.pop_front();
+    break;
+  }
+  finished = parts.empty();
+  inprogress = !finished;
+}
+
+// 304 carries the validators and no body. They are those of the 200 it
+// stands for, weak when that one would have been compressed on the fly
+void Response::assemble_not_modified(std::string const& requested_path) {
+  std::string str(httpversion + statuscode + statusmsg + persistence() +
+                  expires());
+  OpenFile* file = WebServ::open_files.lookup(requested_path);
+  bool compress = false;
+
+  if (location->brotli_static || location->gzip_static || location->gzip)
+    str.append("Vary: Accept-Encoding\n");
+  if (file->err == 0 && static_coding(requested_path).empty())
+    compress = compressible(contenttype, file->size);
+  str.append("Last-Modified: " + last_modified + "\nETag: " +
+             (compress ? "W/" : "") + etag + "\n");
+  str.append(location->headers + "\n");
+  out.push(str);
+  finished = true;
+}
+
+void Response::assemble(std::string const& requested_path) {
   std::string       body;
   size_t            body_size = 0;
+  std::string       body_path;
+  OpenFile*         found;
+  bool              compress = false;
+
+  if (response_code == NOT_MODIFIED) {
+    assemble_not_modified(requested_path);
+    return;
+  }
+  body_path = select_variant(requested_path);
+  found = WebServ::open_files.lookup(body_path);
+  if (found->err == 0 && body_path != DFL_DYNFILE &&
+      response_code == OK &&
+      extra_headers.find("Content-Encoding") == std::string::npos)
+    compress = compressible(contenttype, found->size);
+  if (response_code == OK && requested_path != DFL_DYNFILE) {
+    OpenFile* file = WebServ::open_files.lookup(requested_path);
+    if (file->err == 0) {
+      set_validators(file, body_path == requested_path
+                               ? "" : static_coding(requested_path));
+      // the compressed bytes differ from the file, they are only equivalent
+      extra_headers.append("Last-Modified: " + last_modified + "\nETag: " +
+                           (compress ? "W/" : "") + etag + "\n");
+    }
+    found = WebServ::open_files.lookup(body_path);
+  }
+  if (!compress && response_code == OK && body_path != DFL_DYNFILE)
+    extra_headers.append("Accept-Ranges: bytes\n");
+  if (!compress && assemble_ranges(body_path))
+    return;
+  if (assemble_cached(body_path, compress))
+    return;
+  if (compress) {
+    gzip = new GzipStream(location->gzip_comp_level);
+    if (!gzip->ok()) {
+      delete gzip;
+      gzip = NULL;
+    }
+  }
+  if (method == "HEAD") {
+    // the headers a GET would get, the body is never read
+    body_max_size = found->err ? 0 : found->size;
+    out.push(header(body_max_size));
+    finished = true;
+    return;
+  }
+  if (gzip == NULL && assemble_sendfile(body_path))
+    return;
 
   // WebServ::log.debug() << "File requested: " << path << "\n";
   // WebServ::log.debug() << "Body path: " << body_path << "\n";
@@ -313,26 +1196,16 @@ void Response::assemble(std::string const& body_path) {
   if (file.bad() || file.fail())
     WebServ::log.error() << "file opening in Response::assemble\n";
   file.seekg(std::ios::beg);
-  char buf[BUFFER_SIZE];
+  char* buf = body_buffer();
   file.read(buf, BUFFER_SIZE);
   body_size = file.gcount();
   if (body_max_size < BUFFER_SIZE)
     finished = true;
   else
     inprogress = true;
-  std::string str(httpversion + statuscode + statusmsg + contenttype);
-  if (incorrect_path) {
-    // req->path[req->path.size() - 1] != '/';
-    str.append("Location: " + req->path + "/\n");
-  }
-  str.append(DFL_CONTENTLEN);
-  str.replace(str.find("LENGTH"), 6, _itoa(body_max_size));
-  std::memmove(ResponseBase::buffer_resp, str.c_str(), str.size());
-  std::memmove(&ResponseBase::buffer_resp[str.size()], buf, body_size);
-  ResponseBase::size = str.size() + body_size;
-  ResponseBase::buffer_resp[ResponseBase::size] = '\0';
+  out.push(header(body_max_size));
+  push_body(buf, body_size, finished);
   WebServ::log.debug() << *this;
-  // WebServ::log.debug() << ResponseBase::buffer_resp;
 }
 
 void Response::process(void) {
@@ -346,6 +1219,8 @@ void Response::process(void) {
   if (response_code == 0) {
     response_code = (this->*method_map[method])();
   }
+  if (cgi_out != -1)
+    return;
   if (response_code != 0) {
     set_statuscode(response_code);
     dispatch(response_path);
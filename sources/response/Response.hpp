@@ -8,9 +8,10 @@
 #ifndef HTTPRESPONSE_HPP
 # define HTTPRESPONSE_HPP
 
-#define DFL_TMPFILE "./tmp.html"
+#define DFL_SPOOLFILE "./client_body."
 #define DFL_DYNFILE "./temp.html"
 
+#include <fcntl.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -19,18 +20,26 @@
 #include <dirent.h>
 #include <stdlib.h>
 
-#include<iomanip>
+#include <ctime>
+#include <iomanip>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <deque>
 #include <map>
 #include <vector>
 
 #include "RequestParser.hpp"
 #include "Server.hpp"
 #include "Request.hpp"
-#include "ResponseBase.hpp"
+#include "BufferPool.hpp"
+#include "GzipStream.hpp"
+#include "FastCgi.hpp"
+#include "CgiPool.hpp"
+#include "OpenFileCache.hpp"
+#include "OutputQueue.hpp"
+#include "ResponseCache.hpp"
 #include "WebServ.hpp"
 #include "Logger.hpp"
 
@@ -38,6 +47,13 @@ class Server;
 class Logger;
 class Request;
 
+// a stretch of the body file sent as it is, preceded by `head`
+struct FilePart {
+  std::string head;
+  off_t       pos;
+  size_t      len;
+};
+
 
 class Response {
 typedef void(Response::*funcptr)(void);
@@ -45,6 +61,7 @@ typedef std::map<std::string, int (Response::*)(void)>    meth_map;
 typedef std::vector<int (Response::*)(void)>              function_vector;
 typedef std::map<int, std::string>                        status_map;
 typedef std::map<std::string, std::string>                mimetypes_map;
+typedef std::map<std::string, std::string>                env_map;
 
 private:
   static size_t          id;
@@ -53,6 +70,7 @@ private:
   static meth_map        method_map;
   static function_vector validation_functions;
   static function_vector get_functions;
+  static BufferPool      pool;
 
   static meth_map        init_map();
   static function_vector init_pre();
@@ -62,15 +80,39 @@ private:
 
   int           pid;
   int           io[2];
+  int           cgi_out;
+  std::string   cgi_output;
+  std::string   fastcgi_addr;
+  std::string   upstream;
+  size_t        upstream_sent;
+  int           upstream_body;
+  std::string   upstream_in;
+  bool          upstream_done;
+  bool          cgi_header;
+  off_t         cgi_left;
+  CgiWorker*    worker;
+  size_t        worker_requests;
   size_t        thisid;
   std::ifstream file;
+  char*         body;
+  OpenFile*     body_file;
+  CachedResponse* cached;
+  size_t        served;
+  GzipStream*   gzip;
+  bool          chunked;
+  std::deque<FilePart> parts;
   int           postfile;
-  std::string   postfilename;
+  int           cgi_in;
+  std::string   body_in;
+  bool          body_dropped;
 
   std::string httpversion;
   std::string statuscode;
   std::string statusmsg;
   std::string contenttype;
+  std::string extra_headers;
+  std::string etag;
+  std::string last_modified;
   std::string filetype;
   std::string method;
   size_t      body_max_size;
@@ -99,11 +141,25 @@ private:
   int validate_index(void);
   int validate_path(void);
   int validate_folder(void);
+  int validate_preconditions(void);
+  void set_validators(OpenFile* file, std::string const& coding);
   void set_statuscode(int code);
   void cgi(std::string const& body_path, std::string const &bin);
+  bool spawn_cgi(std::string const& script, std::string const& bin,
+                 int input);
+  void stop_cgi(void);
+  void feed_cgi(void);
+  void fail_cgi(std::string const& reason);
   void dispatch(std::string const& body_path);
   int _post(void);
-  void set_environment(void);
+  void cgi_environment(std::string const& script, env_map* env);
+  bool fastcgi(std::string const& script, std::string const& address,
+               int input);
+  bool pooled(std::string const& script, std::string const& extension,
+              int input);
+  bool has_upstream(void) const;
+  bool upstream_io(void);
+  void forward_cgi(bool last);
   int check_ext(std::string const& body_path);
   int _delete(void);
   int _put(void);
@@ -117,6 +173,24 @@ private:
   void create_error_page(void);
   void create_redir_page(void);
   void create_directory_listing(void);
+  char* body_buffer(void);
+  void release_body(void);
+  bool persistent(void) const;
+  std::string persistence(void);
+  std::string expires(void) const;
+  std::string header(size_t length);
+  std::string fields(size_t length);
+  bool accepts_encoding(std::string const& coding) const;
+  std::string static_coding(std::string const& body_path) const;
+  std::string select_variant(std::string const& body_path);
+  bool compressible(std::string const& type, size_t length) const;
+  void push_body(const char* data, size_t len, bool last);
+  bool assemble_cached(std::string const& body_path, bool compress);
+  bool assemble_sendfile(std::string const& body_path);
+  bool range_applies(OpenFile* file) const;
+  bool assemble_ranges(std::string const& body_path);
+  void assemble_parts(void);
+  void assemble_not_modified(std::string const& requested_path);
 
 public:
   Request*       req;
@@ -125,20 +199,32 @@ public:
   bool           inprogress;
   bool           incorrect_path;
   bool           path_ends_in_slash;
+  bool           keep_alive;
   std::string    response_path;
   int            response_code;
+  OutputQueue    out;
 
   ~Response(void);
   Response(Request *req, Server *_server);
   Response(void);
   void assemble_followup(void);
-  void assemble_cgi(std::string const& body_path);
+  void assemble_cgi(size_t end);
   void assemble(std::string const& body_path);
   void assemble(void);
   void set_request(Request* req);
   void reset(void);
   void process(void);
   void _send(int fd);
+  bool pending(void) const;
+  int cgi_fd(void) const;
+  short cgi_events(void) const;
+  int cgi_input_fd(void) const;
+  short cgi_input_events(void) const;
+  bool wants_body(void) const;
+  bool input_done(void) const;
+  void close_input(void);
+  bool cgi_io(void);
+  void finish_cgi(void);
   std::string get_path(std::string req_path);
   friend std::ostream& operator<<(std::ostream&o, Response const& rhs);
 };
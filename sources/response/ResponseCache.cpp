@@ -0,0 +1,102 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#include "ResponseCache.hpp"
+
+#include <algorithm>
+
+#include "defines.hpp"
+
+ResponseCache::ResponseCache(void)
+    : hits(0),
+      misses(0),
+      budget(DFL_RESPONSE_CACHE),
+      max_file(DFL_RESPONSE_CACHE_MAX_FILE),
+      used(0) { }
+
+ResponseCache::ResponseCache(const ResponseCache&) { }
+
+ResponseCache& ResponseCache::operator=(const ResponseCache&) {
+  return *this;
+}
+
+ResponseCache::~ResponseCache(void) {
+  while (entries.size())
+    _evict(entries.begin()->second);
+}
+
+void ResponseCache::configure(size_t _budget, size_t _max_file) {
+  while (entries.size())
+    _evict(entries.begin()->second);
+  budget = _budget;
+  max_file = std::min(_max_file, _budget);
+}
+
+bool ResponseCache::cacheable(const OpenFile* file) const {
+  return (budget && file->fd != -1 &&
+          static_cast<size_t>(file->size) <= max_file);
+}
+
+CachedResponse* ResponseCache::find(const std::string& key,
+                                    const OpenFile* file) {
+  std::map<std::string, CachedResponse*>::iterator it = entries.find(key);
+  if (it != entries.end()) {
+    CachedResponse* entry = it->second;
+    if (entry->size == file->size && entry->mtime == file->mtime &&
+        entry->inode == file->inode) {
+      recent.splice(recent.begin(), recent, entry->lru);
+      hits++;
+      return (entry);
+    }
+    _evict(entry);
+  }
+  misses++;
+  return (NULL);
+}
+
+// takes over the contents of `data`
+CachedResponse* ResponseCache::insert(const std::string& key,
+                                      const OpenFile* file,
+                                      std::string* data) {
+  CachedResponse* entry = new CachedResponse();
+
+  entry->key = key;
+  entry->data.swap(*data);
+  entry->size = file->size;
+  entry->mtime = file->mtime;
+  entry->inode = file->inode;
+  entry->refs = 0;
+  entry->cached = true;
+  while (recent.size() && used + entry->data.size() > budget)
+    _evict(recent.back());
+  entries[key] = entry;
+  recent.push_front(entry);
+  entry->lru = recent.begin();
+  used += entry->data.size();
+  return (entry);
+}
+
+void ResponseCache::acquire(CachedResponse* entry) {
+  entry->refs++;
+}
+
+void ResponseCache::release(CachedResponse* entry) {
+  if (entry == NULL)
+    return;
+  entry->refs--;
+  if (entry->refs == 0 && !entry->cached)
+    delete entry;
+}
+
+void ResponseCache::_evict(CachedResponse* entry) {
+  entries.erase(entry->key);
+  recent.erase(entry->lru);
+  used -= entry->data.size();
+  entry->cached = false;
+  if (entry->refs == 0)
+    delete entry;
+}
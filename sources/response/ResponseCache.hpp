@@ -0,0 +1,69 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#pragma once
+#ifndef RESPONSECACHE_HPP
+#define RESPONSECACHE_HPP
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <string>
+
+#include "OpenFileCache.hpp"
+
+// A complete 200 response (status line, headers and body) in one block,
+// along with the file identity it was built from
+struct CachedResponse {
+  std::string key;
+  std::string data;
+  off_t size;
+  time_t mtime;
+  ino_t inode;
+  int refs;
+  bool cached;
+  std::list<CachedResponse*>::iterator lru;
+};
+
+// Serialized responses of small static files, so a hit is queued as a single
+// block. Entries are checked against the file's current size, mtime and inode
+// as reported by the open file cache and rebuilt when they differ. The total
+// size of the blocks is kept under `budget` bytes by dropping the least
+// recently used ones. Like OpenFile, an entry being sent must be acquired and
+// is only freed on its last release once evicted.
+class ResponseCache {
+ public:
+  ResponseCache(void);
+  ~ResponseCache(void);
+
+  void configure(size_t budget, size_t max_file);
+  bool cacheable(const OpenFile* file) const;
+  CachedResponse* find(const std::string& key, const OpenFile* file);
+  CachedResponse* insert(const std::string& key, const OpenFile* file,
+                         std::string* data);
+  void acquire(CachedResponse* entry);
+  void release(CachedResponse* entry);
+
+  size_t hits;
+  size_t misses;
+
+ private:
+  ResponseCache(const ResponseCache&);
+  ResponseCache& operator=(const ResponseCache&);
+
+  void _evict(CachedResponse* entry);
+
+  std::map<std::string, CachedResponse*> entries;
+  std::list<CachedResponse*> recent;
+  size_t budget;
+  size_t max_file;
+  size_t used;
+};
+
+#endif  // RESPONSECACHE_HPP
@@ -38,10 +38,8 @@ void Response::find_location(std::string path, Server *server) {
 }
 
 void Response::reset(void) {
-  if (remove_tmp) {
-    unlink(DFL_TMPFILE);
+  if (remove_tmp)
     unlink(DFL_DYNFILE);
-  }
   req = NULL;
   finished = false;
   inprogress = false;
@@ -50,13 +48,36 @@ void Response::reset(void) {
   remove_tmp = false;
   valid = true;
   path_ends_in_slash = false;
+  keep_alive = false;
+  ++served;
   header_present = true;
   response_ready = false;
   response_code = CONTINUE;
   trailing_path.clear();
   response_path.clear();
+  extra_headers.clear();
+  etag.clear();
+  last_modified.clear();
+  out.clear();
+  release_body();
+  WebServ::open_files.release(body_file);
+  body_file = NULL;
+  WebServ::response_cache.release(cached);
+  cached = NULL;
+  delete gzip;
+  gzip = NULL;
+  chunked = false;
+  parts.clear();
   url_parameters.clear();
   file.close();
+  stop_cgi();
+  cgi_output.clear();
+  cgi_header = false;
+  body_in.clear();
+  body_dropped = false;
+  if (postfile != -1)
+    close(postfile);
+  postfile = -1;
   pid = 0;
   statuscode = "200 ";
   statusmsg = "OK\n";
@@ -127,6 +148,7 @@ void Response::set_request(Request *_req) {
   response_code = location->redirect.first;
   if (_req->error)
     response_code = _req->error;
+  keep_alive = persistent();
 
 
   WebServ::log.debug() << location->index[0] << "\n";
@@ -147,8 +169,22 @@ Response::Response(void): req(NULL) {
   remove_tmp = false;
   valid = true;
   path_ends_in_slash = false;
+  keep_alive = false;
+  served = 0;
   response_code = CONTINUE;
   pid = 0;
+  cgi_out = -1;
+  cgi_in = -1;
+  postfile = -1;
+  body_dropped = false;
+  upstream_body = -1;
+  worker = NULL;
+  cgi_header = false;
+  body = NULL;
+  body_file = NULL;
+  cached = NULL;
+  gzip = NULL;
+  chunked = false;
   httpversion = "HTTP/1.1 ";
   statuscode = " 200";
   statusmsg = "OK\n";
@@ -167,22 +203,41 @@ Response::Response(Request *_req, Server *_server)
   remove_tmp = false;
   valid = true;
   path_ends_in_slash = false;
+  keep_alive = false;
+  served = 0;
   response_code = CONTINUE;
   pid = 0;
+  cgi_out = -1;
+  cgi_in = -1;
+  postfile = -1;
+  body_dropped = false;
+  upstream_body = -1;
+  worker = NULL;
+  cgi_header = false;
+  body = NULL;
+  body_file = NULL;
+  cached = NULL;
+  gzip = NULL;
+  chunked = false;
   server = _server;
   thisid = id;
   ++id;
 }
 
 Response::~Response(void) {
-  if (remove_tmp) {
-    unlink(DFL_TMPFILE);
+  if (remove_tmp)
     unlink(DFL_DYNFILE);
-  }
   if (file.is_open())
     file.close();
-  if (postfilename.size()) {
+  out.clear();
+  release_body();
+  WebServ::open_files.release(body_file);
+  body_file = NULL;
+  WebServ::response_cache.release(cached);
+  cached = NULL;
+  delete gzip;
+  gzip = NULL;
+  stop_cgi();
+  if (postfile != -1)
     close(postfile);
-    unlink(postfilename.c_str());
-  }
 }
@@ -15,6 +15,7 @@ int Response::_delete(void) {
   if (access(file, W_OK))
     return UNAUTHORIZED;
   unlink(file);
+  WebServ::open_files.invalidate(path);
   return NO_CONTENT;
 }
 
@@ -47,6 +47,8 @@ void Response::create_directory_listing(void) {
   file.close();
   out.close();
   remove_tmp = true;
+  // the page is rewritten per response, a cached size would be stale
+  WebServ::open_files.invalidate(DFL_DYNFILE);
 }
 
 void Response::create_error_page(void) {
@@ -64,6 +66,7 @@ void Response::create_error_page(void) {
   remove_tmp = true;
   infile.close();
   outfile.close();
+  WebServ::open_files.invalidate(DFL_DYNFILE);
   response_path = DFL_DYNFILE;
 }
 
@@ -85,4 +88,5 @@ void Response::create_redir_page(void) {
   remove_tmp = true;
   infile.close();
   outfile.close();
+  WebServ::open_files.invalidate(DFL_DYNFILE);
 }
@@ -8,13 +8,15 @@
 #include "Response.hpp"
 
 int Response::validate_path(void) {
-  if (!access(path.c_str(), R_OK)) {
+  OpenFile *file = WebServ::open_files.lookup(path);
+
+  if (!file->err) {
     response_path = path;
     return OK;
   }
-  if (errno == ENOENT)
+  if (file->err == ENOENT)
     return NOT_FOUND;
-  else if (errno == EACCES)
+  else if (file->err == EACCES)
     return FORBIDDEN;
   else {
     WebServ::log.warning() << "Unexpected outcome in Response::validate_path\n";
@@ -24,15 +26,15 @@ int Response::validate_path(void) {
 
 
 int Response::validate_folder(void) {
-  struct stat path_stat;
+  OpenFile *file = WebServ::open_files.lookup(path);
 
-  if (stat(path.c_str(), &path_stat) == -1) {
+  if (file->mode == 0) {
     return NOT_FOUND;
   }
-  if (S_ISREG(path_stat.st_mode)) {
+  if (S_ISREG(file->mode)) {
     return CONTINUE;
   }
-  else if (S_ISDIR(path_stat.st_mode)) {
+  else if (S_ISDIR(file->mode)) {
     if (!location->autoindex) {
       // WebServ::log.warning() << "check autoindex config\n";
       if (path == root)
@@ -59,33 +61,85 @@ int Response::validate_index(void) {
     return MOVED_PERMANENTLY;
   }
   if (path == root && location->index.size()) {
+    int err = 0;
     for (size_t i = 0; i < location->index.size(); i++) {
       std::string indexpath = root + "/" + location->index[i];
-      if (!access(indexpath.c_str(), R_OK)) {
+      OpenFile *file = WebServ::open_files.lookup(indexpath);
+      if (!file->err) {
         WebServ::log.debug() << "Redirected to: " << indexpath << "\n";
         response_path = indexpath;
         return OK;
       }
+      err = file->err;
     }
     if (location->autoindex == true) {
       folder_request = true;
     }
-    else if (errno == ENOENT)
+    else if (err == ENOENT)
       return NOT_FOUND;
-    else if (errno == EACCES)
+    else if (err == EACCES)
       return UNAUTHORIZED;
   }
   return CONTINUE;
 }
 
 
+// If-None-Match, or failing that If-Modified-Since, against the file the
+// chain resolved. Only a static regular file has validators to compare
+int Response::validate_preconditions(void) {
+  std::map<std::string, std::string>::const_iterator it;
+  OpenFile *file;
+
+  if (folder_request || response_path.empty())
+    return OK;
+  size_t dot = response_path.find_last_of('.');
+  if (dot != std::string::npos &&
+      (location->cgi.count(response_path.substr(dot)) ||
+       location->fastcgi_pass.count(response_path.substr(dot))))
+    return OK;
+  file = WebServ::open_files.lookup(response_path);
+  if (file->err || !S_ISREG(file->mode))
+    return OK;
+  set_validators(file, static_coding(response_path));
+  it = req->headers.find("If-None-Match");
+  if (it != req->headers.end()) {
+    std::vector<std::string> tags = String::split(it->second, ",");
+    for (size_t i = 0; i < tags.size(); i++) {
+      std::string tag(String::trim(tags[i], " \t"));
+      if (tag.compare(0, 2, "W/") == 0)
+        tag = tag.substr(2);
+      if (tag == "*" || tag == etag)
+        return NOT_MODIFIED;
+    }
+    return OK;
+  }
+  it = req->headers.find("If-Modified-Since");
+  if (it != req->headers.end()) {
+    struct tm date;
+    std::memset(&date, 0, sizeof(date));
+    if (strptime(it->second.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &date) &&
+        file->mtime <= timegm(&date))
+      return NOT_MODIFIED;
+  }
+  return OK;
+}
+
 int Response::_get(void) {
   int code = 0;
 
   for (size_t i = 0; i < get_functions.size() && code == 0; i++)
     code = (this->*get_functions[i])();
+  // the chain stops at the step that resolved the file
+  if (code == OK)
+    code = validate_preconditions();
   if (code)
     return code;
   WebServ::log.warning() << "Unexpected outcome in Response::_get\n";
   return NOT_FOUND;
 }
+
+// HEAD is routed and validated exactly like GET, assemble() then stops
+// after the headers
+int Response::_head(void) {
+  return _get();
+}
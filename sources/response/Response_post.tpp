@@ -7,71 +7,37 @@
 
 #include "Response.hpp"
 
-static std::string fetch_path(std::string const& bin) {
-  int pid;
-  int io[2];
-  char buf[1024];
-
-  pipe(io);
-  pid = fork();
-  if (pid == 0) {
-    dup2(io[1], STDOUT_FILENO);
-    execlp("which", "which", bin.c_str(), NULL);
-  }
-  close(io[1]);
-  pid = read(io[0], buf, 1024);
-  close(io[0]);
-  buf[pid] = '\0';
-  return std::string(buf);
-}
-
 int Response::check_ext(std::string const& extension) {
-  if (server->cgi.count(extension))
+  if (location->cgi.count(extension) || location->fastcgi_pass.count(extension))
     return 0;
   return 1;
 }
 
-void Response::set_environment(void) {
-  in_addr addr;
-
-  // setenv("SERVER_ADDR", "127.0.0.1", 1);
-  // setenv("REMOTE_ADDR", "127.0.0.1", 1);
-  // setenv("REQUEST_SCHEME", "http", 1);
-  // setenv("CONTEXT_PREFIX", "", 1);
-  // setenv("SERVER_ADMIN", "", 1);
-  // setenv("REDIRECT_URL", "/", 1);
-  // setenv("GATEWAY_INTERFACE", "CGI/1.1", 1);
-  // setenv("QUERY_STRING", "", 1);
-  addr.s_addr = server->ip;
-  setenv("SERVER_NAME", (server->server_name[0] + " | " + inet_ntoa(addr)).c_str(), 1);
+// the request as CGI/1.1 variables on top of the location's static ones,
+// for the environment of a child or as the params of a FastCGI request
+void Response::cgi_environment(std::string const& script, env_map* env) {
+  *env = location->cgi_env;
   if (req->headers.count("Host"))
-    setenv("HTTP_HOST", req->headers.at("Host").c_str(), 1);
+    (*env)["HTTP_HOST"] = req->headers.at("Host");
   if (req->headers.count("Referer"))
-    setenv("HTTP_REFERER", req->headers.at("Referer").c_str(), 1);
+    (*env)["HTTP_REFERER"] = req->headers.at("Referer");
   if (req->headers.count("Accept-Language"))
-    setenv("HTTP_ACCEPT_LANGUAGE", req->headers.at("Accept-Language").c_str(), 1);
+    (*env)["HTTP_ACCEPT_LANGUAGE"] = req->headers.at("Accept-Language");
   if (req->headers.count("Accept-Encoding"))
-    setenv("HTTP_ACCEPT_ENCODING", req->headers.at("Accept-Encoding").c_str(), 1);
-  setenv("SERVER_PORT", _itoa(server->port).c_str(), 1);
-  setenv("SERVER_SOFTWARE", "TDD/4.0", 1);
-  setenv("SERVER_PROTOCOL", "HTTP/1.1", 1);
-  setenv("REQUEST_METHOD", "POST", 1);
-  if (!url_parameters.empty())
-    setenv("QUERY_STRING", url_parameters.substr(1).c_str(), 1);
+    (*env)["HTTP_ACCEPT_ENCODING"] = req->headers.at("Accept-Encoding");
   if (req->headers.count("Cookie"))
-    setenv("HTTP_COOKIE", req->headers.at("Cookie").c_str(), 1);
-  setenv("REDIRECT_STATUS", "200", 1);
-  setenv("REQUEST_URI", req->path.c_str(), 1);
-  setenv("PATH_INFO", "/", 1);
-
-  // setenv("SCRIPT_NAME", "/usr/bin/php-cgi", 1);
-  setenv("SCRIPT_NAME", fetch_path(bin).c_str(), 1);
-  setenv("SCRIPT_FILENAME", (location->root + trailing_path).c_str(), 1);
+    (*env)["HTTP_COOKIE"] = req->headers.at("Cookie");
+  (*env)["REQUEST_METHOD"] = method;
+  (*env)["QUERY_STRING"] =
+      url_parameters.empty() ? "" : url_parameters.substr(1);
+  (*env)["REQUEST_URI"] = req->path;
+  (*env)["PATH_INFO"] = "/";
+  (*env)["SCRIPT_NAME"] = req->path;
+  (*env)["SCRIPT_FILENAME"] = script;
   if (req->headers.count("Content-Length"))
-    setenv("CONTENT_LENGTH", req->headers.at("Content-Length").c_str(), 1);
+    (*env)["CONTENT_LENGTH"] = req->headers.at("Content-Length");
   if (req->headers.count("Content-Type"))
-    setenv("CONTENT_TYPE", req->headers.at("Content-Type").c_str(), 1);
-  setenv("REDIRECT_STATUS", "true", 1);
+    (*env)["CONTENT_TYPE"] = req->headers.at("Content-Type");
 }
 
 int Response::_post(void) {
@@ -88,43 +54,57 @@ int Response::_post(void) {
       return INTERNAL_SERVER_ERROR;
   }
 
-  if (postfilename.empty()) {
-    postfilename = DFL_TMPFILE + _itoa(thisid);
-    postfile = open(postfilename.c_str(), O_CREAT | O_RDWR, 0666);
+  std::string extension = path.substr(path.find_last_of('.'));
+  std::string script(location->root + trailing_path);
+  size_t limit = location->client_body_buffer_size;
+  const std::vector<char>& chunk = parser->get_chunk();
+  WebServ::log.debug() << *this;
+
+  // a plain CGI is started right away and reads the body as it arrives,
+  // the client is only read while the child's stdin pipe takes it
+  if (!location->fastcgi_pass.count(extension) &&
+      !server->cgi_pool.count(extension)) {
+    if (!body_dropped && (pid == 0 || cgi_in != -1))
+      body_in.append(chunk.begin(), chunk.end());
+    if (pid == 0 && !spawn_cgi(script, location->cgi[extension], -1))
+      return BAD_GATEWAY;
+    feed_cgi();
+    return (parser->finished && cgi_out != -1) ? OK : CONTINUE;
+  }
+
+  // a FastCGI backend or a worker gets the whole body at once: it is kept
+  // in memory up to client_body_buffer_size and spooled to disk past it
+  if (postfile == -1 && body_in.size() + chunk.size() > limit) {
+    // a unique name, request ids repeat across worker processes
+    char spool[] = DFL_SPOOLFILE "XXXXXX";
+    postfile = mkstemp(spool);
     if (postfile == -1)
-      throw(std::exception());
+      return INTERNAL_SERVER_ERROR;
+    unlink(spool);
+    fcntl(postfile, F_SETFD, FD_CLOEXEC);
+    if (write(postfile, body_in.data(), body_in.size()) == -1)
+      return INTERNAL_SERVER_ERROR;
+    body_in.clear();
   }
-  WebServ::log.debug() << *this;
-  std::vector<char> res;
-  res = parser->get_chunk();
-  write(postfile, &res[0], res.size());
+  if (postfile == -1)
+    body_in.append(chunk.begin(), chunk.end());
+  else if (chunk.size() && write(postfile, &chunk[0], chunk.size()) == -1)
+    return INTERNAL_SERVER_ERROR;
   if (!parser->finished)
     return CONTINUE;
-  close(postfile);
-  std::string extension = path.substr(path.find_last_of('.'));
-  int outfile;
-  int infile;
-  bin = server->cgi[extension];
-  outfile = open(DFL_TMPFILE, O_CREAT | O_RDWR | O_TRUNC, 0777);
-  pid = fork();
-  if (pid == 0) {
-    infile = open(postfilename.c_str(), O_RDONLY, 0666);
-    dup2(infile, STDIN_FILENO);
-    dup2(outfile, STDOUT_FILENO);
-    set_environment();
-    execlp(bin.c_str(), bin.c_str(), (char *)NULL);
+  int infile = postfile;
+  postfile = -1;
+  if (infile != -1)
+    lseek(infile, 0, SEEK_SET);
+  if (location->fastcgi_pass.count(extension)) {
+    if (!fastcgi(script, location->fastcgi_pass[extension], infile))
+      return BAD_GATEWAY;
+    return OK;
   }
-  waitpid(pid, NULL, 0);
-  if (outfile)
-    close(outfile);
-  unlink(postfilename.c_str());
-  postfilename.clear();
-  response_path = DFL_TMPFILE;
-  // WebServ::log.warning() << "Response finished\n";
-  // WebServ::log.warning() << response_path << "\n";
-  response_ready = true;
-  parser->finished = true;
-  remove_tmp = true;
+  if (pooled(script, extension, infile))
+    return OK;
+  if (!spawn_cgi(script, location->cgi[extension], infile))
+    return BAD_GATEWAY;
   return OK;
 }
 
@@ -9,6 +9,8 @@
 
 size_t Response::id = 0;
 
+BufferPool Response::pool(BUFFER_SIZE, POOL_MAX_IDLE);
+
 Response::status_map Response::statuslist = Response::init_status_map();
 Response::status_map Response::init_status_map(void) {
   status_map _map;
@@ -17,9 +19,11 @@ Response::status_map Response::init_status_map(void) {
   _map[201] = "Created\n";
   _map[202] = "Accepted\n";
   _map[204] = "No Content\n";
+  _map[206] = "Partial Content\n";
   _map[300] = "Multiple Choice\n";
   _map[301] = "Moved Permanently\n";
   _map[302] = "Found\n";
+  _map[304] = "Not Modified\n";
   _map[400] = "Bad Request\n";
   _map[401] = "Unauthorized\n";
   _map[403] = "Forbidden\n";
@@ -27,6 +31,7 @@ Response::status_map Response::init_status_map(void) {
   _map[405] = "Method Not Allowed\n";
   _map[413] = "Request Entity Too Large\n";
   _map[415] = "Unsupported Media Type\n";
+  _map[416] = "Range Not Satisfiable\n";
   _map[500] = "Internal Server Error\n";
   _map[502] = "Bad Gateway\n";
   _map[504] = "Gateway Timeout\n";
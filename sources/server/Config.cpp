@@ -9,6 +9,16 @@
 
 Config::Config(void) {
   backlog = DFL_BACKLOG;
+  event_method = DFL_EVENT_METHOD;
+  worker_processes = DFL_WORKER_PROCESSES;
+  worker_cpu_affinity = DFL_WORKER_CPU_AFFINITY;
+  accept_budget = DFL_ACCEPT_BUDGET;
+  open_file_cache = DFL_OPEN_FILE_CACHE;
+  open_file_cache_valid = DFL_OPEN_FILE_CACHE_VALID;
+  open_file_cache_errors = DFL_OPEN_FILE_CACHE_ERRORS;
+  response_cache = DFL_RESPONSE_CACHE;
+  response_cache_max_file = DFL_RESPONSE_CACHE_MAX_FILE;
+  fastcgi_keepalive = DFL_FASTCGI_KEEPALIVE;
 }
 
 Config::Config(const Config& src) {
@@ -22,6 +32,16 @@ Config::~Config(void) {
 Config& Config::operator=(const Config& rhs) {
   if (this != &rhs) {
     backlog = rhs.backlog;
+    event_method = rhs.event_method;
+    worker_processes = rhs.worker_processes;
+    worker_cpu_affinity = rhs.worker_cpu_affinity;
+    accept_budget = rhs.accept_budget;
+    open_file_cache = rhs.open_file_cache;
+    open_file_cache_valid = rhs.open_file_cache_valid;
+    open_file_cache_errors = rhs.open_file_cache_errors;
+    response_cache = rhs.response_cache;
+    response_cache_max_file = rhs.response_cache_max_file;
+    fastcgi_keepalive = rhs.fastcgi_keepalive;
     _servers = rhs._servers;
   }
   return (*this);
@@ -132,11 +152,33 @@ ServerLocation Config::_parse_location(std::istringstream* is) {
       location.limit_except = helper.get_limit_except();
     } else if (directive == "client_max_body_size") {
       location.client_max_body_size = helper.get_client_max_body_size();
+    } else if (directive == "client_body_buffer_size") {
+      location.client_body_buffer_size = helper.get_client_body_buffer_size();
     } else if (directive == "autoindex") {
       location.autoindex = helper.get_autoindex();
+    } else if (directive == "sendfile") {
+      location.sendfile = helper.get_sendfile();
+    } else if (directive == "gzip_static") {
+      location.gzip_static = helper.get_gzip_static();
+    } else if (directive == "brotli_static") {
+      location.brotli_static = helper.get_brotli_static();
+    } else if (directive == "gzip") {
+      location.gzip = helper.get_gzip();
+    } else if (directive == "gzip_types") {
+      location.gzip_types = helper.get_gzip_types();
+    } else if (directive == "gzip_min_length") {
+      location.gzip_min_length = helper.get_gzip_min_length();
+    } else if (directive == "gzip_comp_level") {
+      location.gzip_comp_level = helper.get_gzip_comp_level();
+    } else if (directive == "expires") {
+      location.expires = helper.get_expires();
+    } else if (directive == "add_header") {
+      location.add_header.push_back(helper.get_add_header());
     } else if (directive == "cgi") {
       location.cgi[tokens[1]] = helper.get_cgi();
-      cgi_list.insert(tokens[2]);
+      cgi_list.insert(location.cgi[tokens[1]]);
+    } else if (directive == "fastcgi_pass") {
+      location.fastcgi_pass[tokens[1]] = helper.get_fastcgi_pass();
     } else if (directive == "return") {
       location.redirect = helper.get_redirect();
     } else if (directive == "upload") {
@@ -182,17 +224,45 @@ Server Config::_parse_server(std::istringstream* is) {
       srv.error_page[code] = helper.get_error_page();
     } else if (directive == "timeout") {
       srv.timeout = helper.get_timeout();
+    } else if (directive == "keepalive_requests") {
+      srv.keepalive_requests = helper.get_keepalive_requests();
+    } else if (directive == "keepalive_timeout") {
+      srv.keepalive_timeout = helper.get_keepalive_timeout();
     } else if (directive == "client_max_body_size") {
       srv.client_max_body_size = helper.get_client_max_body_size();
+    } else if (directive == "client_body_buffer_size") {
+      srv.client_body_buffer_size = helper.get_client_body_buffer_size();
     } else if (directive == "access_log") {
       srv.log["access_log"] = helper.get_access_log();
     } else if (directive == "error_log") {
       srv.log["error_log"] = helper.get_error_log();
     } else if (directive == "autoindex") {
       srv.autoindex = helper.get_autoindex();
+    } else if (directive == "sendfile") {
+      srv.sendfile = helper.get_sendfile();
+    } else if (directive == "gzip_static") {
+      srv.gzip_static = helper.get_gzip_static();
+    } else if (directive == "brotli_static") {
+      srv.brotli_static = helper.get_brotli_static();
+    } else if (directive == "gzip") {
+      srv.gzip = helper.get_gzip();
+    } else if (directive == "gzip_types") {
+      srv.gzip_types = helper.get_gzip_types();
+    } else if (directive == "gzip_min_length") {
+      srv.gzip_min_length = helper.get_gzip_min_length();
+    } else if (directive == "gzip_comp_level") {
+      srv.gzip_comp_level = helper.get_gzip_comp_level();
+    } else if (directive == "expires") {
+      srv.expires = helper.get_expires();
+    } else if (directive == "add_header") {
+      srv.add_header.push_back(helper.get_add_header());
     } else if (directive == "cgi") {
       srv.cgi[tokens[1]] = helper.get_cgi();
-      cgi_list.insert(tokens[2]);
+      cgi_list.insert(srv.cgi[tokens[1]]);
+    } else if (directive == "fastcgi_pass") {
+      srv.fastcgi_pass[tokens[1]] = helper.get_fastcgi_pass();
+    } else if (directive == "cgi_pool") {
+      srv.cgi_pool[tokens[1]] = helper.get_cgi_pool();
     } else if (directive == "return") {
       srv.redirect = helper.get_redirect();
     } else if (directive == "upload") {
@@ -213,6 +283,13 @@ Server Config::_parse_server(std::istringstream* is) {
   srv.fill();
   if (srv.is_invalid())
     throw ConfigHelper::NotSpecified(srv.error);
+  // the workers run a Python request loop, other interpreters are not pooled
+  std::map<std::string, std::pair<int, int> >::iterator it;
+  for (it = srv.cgi_pool.begin(); it != srv.cgi_pool.end(); it++) {
+    std::string bin(srv.cgi.count(it->first) ? srv.cgi[it->first] : "");
+    if (bin.substr(bin.find_last_of('/') + 1).compare(0, 6, "python"))
+      throw ConfigHelper::InvFieldValue("cgi_pool", it->first);
+  }
 
   return (srv);
 }
@@ -220,6 +297,7 @@ Server Config::_parse_server(std::istringstream* is) {
 void Config::_parse(std::istringstream* is) {
   std::string line, directive;
   std::vector<std::string> tokens;
+  std::vector<std::string> global = String::split(CFG_FIELD_GLOBAL, " ");
   ConfigHelper helper;
 
   while (std::getline(*is, line)) {
@@ -230,10 +308,32 @@ void Config::_parse(std::istringstream* is) {
 
     if (helper.directive_already_exists())
       throw ConfigHelper::DirectiveDuplicate(tokens[0]);
-    if (directive == "workers" && _servers.size())
+    if (_servers.size() &&
+        std::find(global.begin(), global.end(), directive) != global.end())
       throw ConfigHelper::DirectiveGlobal(tokens[0]);
-    if (directive == "workers")
+    // "workers" predates worker_processes and has always meant the backlog
+    if (directive == "workers" || directive == "backlog")
       backlog = helper.get_backlog();
+    else if (directive == "use")
+      event_method = helper.get_event_method();
+    else if (directive == "worker_processes")
+      worker_processes = helper.get_worker_processes();
+    else if (directive == "worker_cpu_affinity")
+      worker_cpu_affinity = helper.get_worker_cpu_affinity();
+    else if (directive == "accept_budget")
+      accept_budget = helper.get_accept_budget();
+    else if (directive == "open_file_cache")
+      open_file_cache = helper.get_open_file_cache();
+    else if (directive == "open_file_cache_valid")
+      open_file_cache_valid = helper.get_open_file_cache_valid();
+    else if (directive == "open_file_cache_errors")
+      open_file_cache_errors = helper.get_open_file_cache_errors();
+    else if (directive == "response_cache")
+      response_cache = helper.get_response_cache();
+    else if (directive == "response_cache_max_file")
+      response_cache_max_file = helper.get_response_cache_max_file();
+    else if (directive == "fastcgi_keepalive")
+      fastcgi_keepalive = helper.get_fastcgi_keepalive();
     else if (directive == "server")
       _servers.push_back(_parse_server(is));
     else
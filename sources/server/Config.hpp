@@ -51,6 +51,16 @@ class Config {
 
  public:
   int backlog;
+  std::string event_method;
+  int worker_processes;
+  bool worker_cpu_affinity;
+  int accept_budget;
+  int open_file_cache;
+  int open_file_cache_valid;
+  bool open_file_cache_errors;
+  int response_cache;
+  int response_cache_max_file;
+  int fastcgi_keepalive;
   std::set<std::string> cgi_list;
 
  private:
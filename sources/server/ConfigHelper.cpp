@@ -7,6 +7,11 @@
 
 #include "ConfigHelper.hpp"
 
+#include <unistd.h>
+
+#include <cctype>
+#include <cstdlib>
+
 ConfigHelper::ConfigHelper(void) {
   return;
 }
@@ -65,6 +70,105 @@ int ConfigHelper::get_backlog(void) {
   return (backlog);
 }
 
+std::string ConfigHelper::get_event_method(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  std::vector<std::string> cmp = String::split(CFG_FIELD_EVENT_METHOD, " ");
+  if (std::find(cmp.begin(), cmp.end(), _tokens[1]) == cmp.end())
+    throw InvFieldValue("use", _tokens[1]);
+  return (_tokens[1]);
+}
+
+int ConfigHelper::get_worker_processes(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1] == "auto")
+    return (std::max(1L, sysconf(_SC_NPROCESSORS_ONLN)));
+  if (_tokens[1].find_first_not_of("0123456789") != std::string::npos ||
+      String::to_int(_tokens[1]) < CFG_MIN_WORKER_PROCESSES ||
+      String::to_int(_tokens[1]) > CFG_MAX_WORKER_PROCESSES)
+    throw DirectiveInvValue(_tokens[0]);
+  return (String::to_int(_tokens[1]));
+}
+
+bool ConfigHelper::get_worker_cpu_affinity(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1] != "on" && _tokens[1] != "off")
+    throw InvFieldValue("worker_cpu_affinity", _tokens[1]);
+  return ((_tokens[1] == "on") ? true : false);
+}
+
+int ConfigHelper::get_accept_budget(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1].find_first_not_of("0123456789") != std::string::npos ||
+      String::to_int(_tokens[1]) < CFG_MIN_ACCEPT_BUDGET ||
+      String::to_int(_tokens[1]) > CFG_MAX_ACCEPT_BUDGET)
+    throw DirectiveInvValue(_tokens[0]);
+  return (String::to_int(_tokens[1]));
+}
+
+// "off" is the same as a cache of 0 entries
+int ConfigHelper::get_open_file_cache(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1] == "off")
+    return (0);
+  if (_tokens[1].find_first_not_of("0123456789") != std::string::npos ||
+      String::to_int(_tokens[1]) > CFG_MAX_OPEN_FILE_CACHE)
+    throw DirectiveInvValue(_tokens[0]);
+  return (String::to_int(_tokens[1]));
+}
+
+int ConfigHelper::get_open_file_cache_valid(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1].find_first_not_of("0123456789") != std::string::npos ||
+      String::to_int(_tokens[1]) > CFG_MAX_OPEN_FILE_CACHE_VALID)
+    throw DirectiveInvValue(_tokens[0]);
+  return (String::to_int(_tokens[1]));
+}
+
+bool ConfigHelper::get_open_file_cache_errors(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1] != "on" && _tokens[1] != "off")
+    throw InvFieldValue("open_file_cache_errors", _tokens[1]);
+  return ((_tokens[1] == "on") ? true : false);
+}
+
+// budget in bytes, "off" disables the cache
+int ConfigHelper::get_response_cache(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1] == "off")
+    return (0);
+  if (_tokens[1].find_first_not_of("0123456789") != std::string::npos ||
+      String::to_int(_tokens[1]) > CFG_MAX_RESPONSE_CACHE)
+    throw DirectiveInvValue(_tokens[0]);
+  return (String::to_int(_tokens[1]));
+}
+
+int ConfigHelper::get_response_cache_max_file(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1].find_first_not_of("0123456789") != std::string::npos ||
+      String::to_int(_tokens[1]) > CFG_MAX_RESPONSE_CACHE)
+    throw DirectiveInvValue(_tokens[0]);
+  return (String::to_int(_tokens[1]));
+}
+
+// idle connections kept open to each FastCGI backend
+int ConfigHelper::get_fastcgi_keepalive(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1].find_first_not_of("0123456789") != std::string::npos ||
+      String::to_int(_tokens[1]) > CFG_MAX_FASTCGI_KEEPALIVE)
+    throw DirectiveInvValue(_tokens[0]);
+  return (String::to_int(_tokens[1]));
+}
+
 std::pair<in_addr_t, int> ConfigHelper::get_listen(void) {
   in_addr_t ip;
   int port;
@@ -155,6 +259,24 @@ size_t ConfigHelper::get_timeout(void) {
   return (String::to_int(_tokens[1]));
 }
 
+int ConfigHelper::get_keepalive_requests(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1].find_first_not_of("0123456789") != std::string::npos ||
+      String::to_int(_tokens[1]) > CFG_MAX_KEEPALIVE_REQUESTS)
+    throw DirectiveInvValue(_tokens[0]);
+  return (String::to_int(_tokens[1]));
+}
+
+int ConfigHelper::get_keepalive_timeout(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1].find_first_not_of("0123456789") != std::string::npos ||
+      String::to_int(_tokens[1]) > CFG_MAX_TIMEOUT)
+    throw DirectiveInvValue(_tokens[0]);
+  return (String::to_int(_tokens[1]));
+}
+
 int ConfigHelper::get_client_max_body_size(void) {
   if (_tokens.size() != 2)
     throw InvalidNumberArgs(_tokens[0]);
@@ -164,6 +286,16 @@ int ConfigHelper::get_client_max_body_size(void) {
   return (String::to_int(_tokens[1]) * 1000000);
 }
 
+// in bytes, request bodies past it are spooled to disk
+int ConfigHelper::get_client_body_buffer_size(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1].find_first_not_of("0123456789") != std::string::npos ||
+      String::to_int(_tokens[1]) > CFG_MAX_CLI_BODY_BUFFER_SIZE)
+    throw DirectiveInvValue(_tokens[0]);
+  return (String::to_int(_tokens[1]));
+}
+
 std::string ConfigHelper::get_access_log(void) {
   if (_tokens.size() != 2)
     throw InvalidNumberArgs(_tokens[0]);
@@ -188,16 +320,149 @@ bool ConfigHelper::get_autoindex(void) {
   return ((_tokens[1] == "on") ? true : false);
 }
 
+bool ConfigHelper::get_sendfile(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1] != "on" && _tokens[1] != "off")
+    throw InvFieldValue("sendfile", _tokens[1]);
+  return ((_tokens[1] == "on") ? true : false);
+}
+
+bool ConfigHelper::get_gzip_static(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1] != "on" && _tokens[1] != "off")
+    throw InvFieldValue("gzip_static", _tokens[1]);
+  return ((_tokens[1] == "on") ? true : false);
+}
+
+bool ConfigHelper::get_brotli_static(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1] != "on" && _tokens[1] != "off")
+    throw InvFieldValue("brotli_static", _tokens[1]);
+  return ((_tokens[1] == "on") ? true : false);
+}
+
+bool ConfigHelper::get_gzip(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1] != "on" && _tokens[1] != "off")
+    throw InvFieldValue("gzip", _tokens[1]);
+  return ((_tokens[1] == "on") ? true : false);
+}
+
+std::vector<std::string> ConfigHelper::get_gzip_types(void) {
+  if (_tokens.size() == 1)
+    throw InvalidNumberArgs(_tokens[0]);
+  std::vector<std::string> tmp(_tokens.begin() + 1, _tokens.end());
+  for (size_t i = 0; i < tmp.size(); i++) {
+    std::transform(tmp[i].begin(), tmp[i].end(), tmp[i].begin(), ::tolower);
+    if (tmp[i] != "*" && tmp[i].find('/') == std::string::npos)
+      throw InvFieldValue("gzip_types", tmp[i]);
+  }
+  return (tmp);
+}
+
+int ConfigHelper::get_gzip_min_length(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1].find_first_not_of("0123456789") != std::string::npos ||
+      String::to_int(_tokens[1]) > CFG_MAX_RESPONSE_CACHE)
+    throw DirectiveInvValue(_tokens[0]);
+  return (String::to_int(_tokens[1]));
+}
+
+int ConfigHelper::get_gzip_comp_level(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (_tokens[1].find_first_not_of("0123456789") != std::string::npos ||
+      String::to_int(_tokens[1]) < CFG_MIN_GZIP_COMP_LEVEL ||
+      String::to_int(_tokens[1]) > CFG_MAX_GZIP_COMP_LEVEL)
+    throw DirectiveInvValue(_tokens[0]);
+  return (String::to_int(_tokens[1]));
+}
+
+// off, epoch, max or a time such as 30d, 12h, 90m, 3600s or -1
+std::string ConfigHelper::get_expires(void) {
+  if (_tokens.size() != 2)
+    throw InvalidNumberArgs(_tokens[0]);
+  std::string value(_tokens[1]);
+  if (value == "off" || value == "epoch" || value == "max")
+    return (value);
+  size_t start = (value[0] == '-') ? 1 : 0;
+  size_t end = value.find_first_not_of("0123456789", start);
+  if (end == start ||
+      (end != std::string::npos &&
+       (end != value.size() - 1 || std::string("smhdw").find(value[end]) ==
+                                       std::string::npos)))
+    throw InvFieldValue("expires", value);
+  if (String::to_int(value.substr(start, end - start)) > CFG_MAX_EXPIRES)
+    throw DirectiveInvValue(_tokens[0]);
+  return (value);
+}
+
+// add_header Name value..., kept as the header line it produces
+std::string ConfigHelper::get_add_header(void) {
+  if (_tokens.size() < 3)
+    throw InvalidNumberArgs(_tokens[0]);
+  for (size_t i = 0; i < _tokens[1].size(); i++) {
+    if (!std::isalnum(_tokens[1][i]) && _tokens[1][i] != '-')
+      throw InvFieldValue("add_header", _tokens[1]);
+  }
+  std::string line(_tokens[1] + ":");
+  for (size_t i = 2; i < _tokens.size(); i++)
+    line.append(" " + _tokens[i]);
+  return (line + "\n");
+}
+
+// the interpreter is resolved here once, children are started from that
+// path without a PATH search
 std::string ConfigHelper::get_cgi(void) {
   if (_tokens.size() != 3)
     throw InvalidNumberArgs(_tokens[0]);
   if (!_valid_cgi_ext(_tokens[1]))
     throw InvFieldValue("cgi", _tokens[1]);
-  if (!_valid_cgi_bin(_tokens[2]))
+  std::string bin(_resolve_cgi_bin(_tokens[2]));
+  if (bin.empty())
     throw SystemError("cgi", _tokens[2]);
+  return (bin);
+}
+
+// the backend is either "unix:/path/to/socket" or "ip:port"
+std::string ConfigHelper::get_fastcgi_pass(void) {
+  if (_tokens.size() != 3)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (!_valid_cgi_ext(_tokens[1]))
+    throw InvFieldValue("fastcgi_pass", _tokens[1]);
+  if (!_valid_fastcgi_address(_tokens[2]))
+    throw InvFieldValue("fastcgi_pass", _tokens[2]);
   return (_tokens[2]);
 }
 
+// "cgi_pool .py 4" or "cgi_pool .py 4 500", the size of the pool and the
+// requests a worker serves before it is replaced
+std::pair<int, int> ConfigHelper::get_cgi_pool(void) {
+  int requests = DFL_CGI_POOL_REQUESTS;
+
+  if (_tokens.size() != 3 && _tokens.size() != 4)
+    throw InvalidNumberArgs(_tokens[0]);
+  if (!_valid_cgi_ext(_tokens[1]))
+    throw InvFieldValue("cgi_pool", _tokens[1]);
+  if (_tokens[2].find_first_not_of("0123456789") != std::string::npos ||
+      String::to_int(_tokens[2]) < 1 ||
+      String::to_int(_tokens[2]) > CFG_MAX_CGI_POOL)
+    throw InvFieldValue("cgi_pool", _tokens[2]);
+  if (_tokens.size() == 4) {
+    if (_tokens[3].find_first_not_of("0123456789") != std::string::npos ||
+        String::to_int(_tokens[3]) < 1 ||
+        String::to_int(_tokens[3]) > CFG_MAX_KEEPALIVE_REQUESTS)
+      throw InvFieldValue("cgi_pool", _tokens[3]);
+    requests = String::to_int(_tokens[3]);
+  }
+  return (std::make_pair(String::to_int(_tokens[2]), requests));
+}
+
 std::pair<int, std::string> ConfigHelper::get_redirect(void) {
   if (_tokens.size() != 3)
     throw InvalidNumberArgs(_tokens[0]);
@@ -338,25 +603,37 @@ bool ConfigHelper::_valid_cgi_ext(const std::string& ext) {
   return (true);
 }
 
-bool ConfigHelper::_valid_cgi_bin(const std::string& bin) {
+// the path of an interpreter, looked up in PATH when given by name, like
+// execvp() would. Symlinks are kept, an interpreter may rely on the name it
+// is run as. Empty when no executable file was found.
+std::string ConfigHelper::_resolve_cgi_bin(const std::string& bin) {
+  std::vector<std::string> path;
   struct stat statbuf;
-  if (stat(bin.c_str(), &statbuf) == 0 && statbuf.st_mode & S_IXUSR)
-    return (true);
-  if (stat(bin.c_str(), &statbuf) == 0 && !(statbuf.st_mode & S_IXUSR)) {
-    errno = EACCES;
-    return (false);
+
+  if (bin.find('/') != std::string::npos) {
+    path.push_back(bin);
+  } else if (std::getenv("PATH")) {
+    path = String::split(std::getenv("PATH"), ":");
+    for (size_t i = 0; i < path.size(); i++)
+      path[i] += "/" + bin;
   }
-  std::vector<std::string> path = String::split(std::getenv("PATH"), ":");
+  int error = ENOENT;
   for (size_t i = 0; i < path.size(); i++) {
-    std::string exe(path[i] + "/" + bin);
-    if (stat(exe.c_str(), &statbuf) == 0 && !(statbuf.st_mode & S_IXUSR)) {
-      errno = EACCES;
-      return (false);
-    }
-    if (stat(exe.c_str(), &statbuf) == 0 && statbuf.st_mode & S_IXUSR)
-      return (true);
+    if (stat(path[i].c_str(), &statbuf) != 0 || !S_ISREG(statbuf.st_mode))
+      continue;
+    if (access(path[i].c_str(), X_OK) == 0)
+      return (path[i]);
+    error = EACCES;
   }
-  return (false);
+  errno = error;
+  return ("");
+}
+
+bool ConfigHelper::_valid_fastcgi_address(const std::string& address) {
+  if (address.compare(0, 5, "unix:") == 0)
+    return (address.size() > 5 && address.size() - 5 < CFG_MAX_UNIX_PATH);
+  std::vector<std::string> tmp = String::split(address, ":");
+  return (tmp.size() == 2 && _valid_ip(tmp[0]) && _valid_port(tmp[1]));
 }
 
 ConfigHelper::InvalidNumberArgs::InvalidNumberArgs(const std::string& str)
@@ -40,17 +40,41 @@ class ConfigHelper {
   bool directive_already_exists(void);
 
   int get_backlog(void);
+  std::string get_event_method(void);
+  int get_worker_processes(void);
+  bool get_worker_cpu_affinity(void);
+  int get_accept_budget(void);
+  int get_open_file_cache(void);
+  int get_open_file_cache_valid(void);
+  bool get_open_file_cache_errors(void);
+  int get_response_cache(void);
+  int get_response_cache_max_file(void);
+  int get_fastcgi_keepalive(void);
   std::pair<in_addr_t, int> get_listen(void);
   std::vector<std::string> get_server_name(void);
   std::string get_root(void);
   std::vector<std::string> get_index(void);
   std::string get_error_page(void);
   size_t get_timeout(void);
+  int get_keepalive_requests(void);
+  int get_keepalive_timeout(void);
   int get_client_max_body_size(void);
+  int get_client_body_buffer_size(void);
   std::string get_access_log(void);
   std::string get_error_log(void);
   bool get_autoindex(void);
+  bool get_sendfile(void);
+  bool get_gzip_static(void);
+  bool get_brotli_static(void);
+  bool get_gzip(void);
+  std::vector<std::string> get_gzip_types(void);
+  int get_gzip_min_length(void);
+  int get_gzip_comp_level(void);
+  std::string get_expires(void);
+  std::string get_add_header(void);
   std::string get_cgi(void);
+  std::string get_fastcgi_pass(void);
+  std::pair<int, int> get_cgi_pool(void);
   std::pair<int, std::string> get_redirect(void);
   std::vector<std::string> get_limit_except(void);
   bool get_upload(void);
@@ -64,7 +88,8 @@ class ConfigHelper {
   bool _valid_error_page(const std::string& error_page);
   bool _valid_log(const std::string& log);
   bool _valid_cgi_ext(const std::string& ext);
-  bool _valid_cgi_bin(const std::string& bin);
+  std::string _resolve_cgi_bin(const std::string& bin);
+  bool _valid_fastcgi_address(const std::string& address);
 
   std::vector<std::string> _tokens;
   std::multiset<std::string> _list;
@@ -12,9 +12,18 @@ Server::Server(void) {
   port = -1;
   root = "";
   timeout = 0;
+  keepalive_requests = -1;
+  keepalive_timeout = -1;
   client_max_body_size = -1;
+  client_body_buffer_size = -1;
   redirect = std::make_pair(0, "");
   autoindex = -1;
+  sendfile = -1;
+  gzip_static = -1;
+  brotli_static = -1;
+  gzip = -1;
+  gzip_min_length = -1;
+  gzip_comp_level = -1;
   sockfd = DFL_SOCK_FD;
   upload = -1;
   upload_store = "";
@@ -38,12 +47,26 @@ Server& Server::operator=(const Server& rhs) {
     index = rhs.index;
     error_page = rhs.error_page;
     timeout = rhs.timeout;
+    keepalive_requests = rhs.keepalive_requests;
+    keepalive_timeout = rhs.keepalive_timeout;
     client_max_body_size = rhs.client_max_body_size;
+    client_body_buffer_size = rhs.client_body_buffer_size;
     log = rhs.log;
     cgi = rhs.cgi;
+    fastcgi_pass = rhs.fastcgi_pass;
+    cgi_pool = rhs.cgi_pool;
     redirect = rhs.redirect;
     location = rhs.location;
     autoindex = rhs.autoindex;
+    sendfile = rhs.sendfile;
+    gzip_static = rhs.gzip_static;
+    brotli_static = rhs.brotli_static;
+    gzip = rhs.gzip;
+    gzip_types = rhs.gzip_types;
+    gzip_min_length = rhs.gzip_min_length;
+    gzip_comp_level = rhs.gzip_comp_level;
+    expires = rhs.expires;
+    add_header = rhs.add_header;
     sockfd = rhs.sockfd;
     upload = rhs.upload;
     upload_store = rhs.upload_store;
@@ -66,10 +89,30 @@ void Server::fill(void) {
     error_page[405] = DFL_405_PAGE;
   if (timeout == 0)
     timeout = DFL_TIMEOUT;
+  if (keepalive_requests == -1)
+    keepalive_requests = DFL_KEEPALIVE_REQUESTS;
+  if (keepalive_timeout == -1)
+    keepalive_timeout = DFL_KEEPALIVE_TIMEOUT;
   if (client_max_body_size == -1)
     client_max_body_size = DFL_CLI_MAX_BODY_SIZE;
+  if (client_body_buffer_size == -1)
+    client_body_buffer_size = DFL_CLI_BODY_BUFFER_SIZE;
   if (autoindex == -1)
     autoindex = DFL_AUTO_INDEX;
+  if (sendfile == -1)
+    sendfile = DFL_SENDFILE;
+  if (gzip_static == -1)
+    gzip_static = DFL_GZIP_STATIC;
+  if (brotli_static == -1)
+    brotli_static = DFL_BROTLI_STATIC;
+  if (gzip == -1)
+    gzip = DFL_GZIP;
+  if (gzip_types.size() == 0)
+    gzip_types = String::split(DFL_GZIP_TYPES, " ");
+  if (gzip_min_length == -1)
+    gzip_min_length = DFL_GZIP_MIN_LENGTH;
+  if (gzip_comp_level == -1)
+    gzip_comp_level = DFL_GZIP_COMP_LEVEL;
   std::map<std::string, ServerLocation>::iterator it;
   for (it = location.begin(); it != location.end(); it++)
     it->second.fill(*this);
@@ -92,14 +135,14 @@ bool Server::is_invalid(void) {
 }
 
 void Server::_socket(void) {
-  sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  sockfd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
   if (sockfd == -1)
     throw ConnectException("socket");
   if (fcntl(sockfd, F_SETFL, O_NONBLOCK) == -1)
     throw ConnectException("fcntl");
 }
 
-void Server::_bind(void) {
+void Server::_bind(bool reuseport) {
   struct sockaddr_in sockaddress;
 
   sockaddress.sin_family = AF_INET;
@@ -109,6 +152,10 @@ void Server::_bind(void) {
   int yes = 1;
   if (setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes))
     throw ConnectException("setsockopt");
+  // every worker binds its own socket and the kernel spreads connections
+  if (reuseport &&
+      setsockopt(sockfd, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof yes))
+    throw ConnectException("setsockopt");
   if (bind(sockfd, (const sockaddr*)&sockaddress, sizeof(sockaddr_in)))
     throw BindException("bind", port, ip);
 }
@@ -118,9 +165,9 @@ void Server::_listen(int backlog) {
     throw ConnectException("listen");
 }
 
-int Server::_connect(int backlog) {
+int Server::_connect(int backlog, bool reuseport) {
   _socket();
-  _bind();
+  _bind(reuseport);
   _listen(backlog);
   return 0;
 }
@@ -154,20 +201,65 @@ void Server::print(void) {
 
   std::cout << "timeout: =>" << timeout << "<=\n";
 
+  std::cout << "keepalive_requests: =>" << keepalive_requests << "<=\n";
+
+  std::cout << "keepalive_timeout: =>" << keepalive_timeout << "<=\n";
+
   std::cout << "client_max_body_size: =>" << client_max_body_size << "<=\n";
 
+  std::cout << "client_body_buffer_size: =>" << client_body_buffer_size
+            << "<=\n";
+
   std::cout << "access_log: =>" << log["access_log"] << "<=\n";
 
   std::cout << "error_log: =>" << log["error_log"] << "<=\n";
 
   std::cout << "autoindex: =>" << autoindex << "<=\n";
 
+  std::cout << "sendfile: =>" << sendfile << "<=\n";
+
+  std::cout << "gzip_static: =>" << gzip_static << "<=\n";
+
+  std::cout << "brotli_static: =>" << brotli_static << "<=\n";
+
+  std::cout << "gzip: =>" << gzip << "<=\n";
+
+  for (size_t i = 0; i < gzip_types.size(); i++) {
+    std::cout << "gzip_types: =>" << gzip_types[i] << "<=\n";
+  }
+
+  std::cout << "gzip_min_length: =>" << gzip_min_length << "<=\n";
+
+  std::cout << "gzip_comp_level: =>" << gzip_comp_level << "<=\n";
+
+  std::cout << "expires: =>" << expires << "<=\n";
+
+  for (size_t i = 0; i < add_header.size(); i++) {
+    std::cout << "add_header: =>" << add_header[i] << "<=\n";
+  }
+
   for (std::map<std::string, std::string>::const_iterator it = cgi.begin();
        it != cgi.end();
        it++) {
     std::cout << "cgi: =>" << it->first << "<= =>" << it->second << "<=\n";
   }
 
+  for (std::map<std::string, std::string>::const_iterator
+           it = fastcgi_pass.begin();
+       it != fastcgi_pass.end();
+       it++) {
+    std::cout << "fastcgi_pass: =>" << it->first << "<= =>"
+              << it->second << "<=\n";
+  }
+
+  for (std::map<std::string, std::pair<int, int> >::const_iterator
+           it = cgi_pool.begin();
+       it != cgi_pool.end();
+       it++) {
+    std::cout << "cgi_pool: =>" << it->first << "<= =>" << it->second.first
+              << "<= =>" << it->second.second << "<=\n";
+  }
+
   std::cout << "redirect: =>" << redirect.first << "<= =>"
             << redirect.second << "<=\n";
 
@@ -199,8 +291,39 @@ void Server::print(void) {
     std::cout << "    client_max_body_size: =>"
               << location[index].client_max_body_size << "<=\n";
 
+    std::cout << "    client_body_buffer_size: =>"
+              << location[index].client_body_buffer_size << "<=\n";
+
     std::cout << "    autoindex: =>" << location[index].autoindex << "<=\n";
 
+    std::cout << "    sendfile: =>" << location[index].sendfile << "<=\n";
+
+    std::cout << "    gzip_static: =>"
+              << location[index].gzip_static << "<=\n";
+
+    std::cout << "    brotli_static: =>"
+              << location[index].brotli_static << "<=\n";
+
+    std::cout << "    gzip: =>" << location[index].gzip << "<=\n";
+
+    for (size_t i = 0; i < location[index].gzip_types.size(); i++) {
+      std::cout << "    gzip_types: =>"
+                << location[index].gzip_types[i] << "<=\n";
+    }
+
+    std::cout << "    gzip_min_length: =>"
+              << location[index].gzip_min_length << "<=\n";
+
+    std::cout << "    gzip_comp_level: =>"
+              << location[index].gzip_comp_level << "<=\n";
+
+    std::cout << "    expires: =>" << location[index].expires << "<=\n";
+
+    for (size_t i = 0; i < location[index].add_header.size(); i++) {
+      std::cout << "    add_header: =>"
+                << location[index].add_header[i] << "<=\n";
+    }
+
     for (std::map<std::string, std::string>::const_iterator
              it = location[index].cgi.begin();
          it != location[index].cgi.end();
@@ -209,6 +332,14 @@ void Server::print(void) {
                 << it->second << "<=\n";
     }
 
+    for (std::map<std::string, std::string>::const_iterator
+             it = location[index].fastcgi_pass.begin();
+         it != location[index].fastcgi_pass.end();
+         it++) {
+      std::cout << "    fastcgi_pass: =>" << it->first << "<= =>"
+                << it->second << "<=\n";
+    }
+
     std::cout << "    redirect: =>" << location[index].redirect.first
               << "<= =>" << location[index].redirect.second << "<=\n";
 
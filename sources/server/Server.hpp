@@ -44,12 +44,27 @@ class Server {
   std::vector<std::string> index;
   std::map<int, std::string> error_page;
   size_t timeout;
+  int keepalive_requests;
+  int keepalive_timeout;
   int client_max_body_size;
+  int client_body_buffer_size;
   std::map<std::string, std::string> log;
   std::map<std::string, std::string> cgi;
+  std::map<std::string, std::string> fastcgi_pass;
+  // workers and requests per worker of the prefork pool of an extension
+  std::map<std::string, std::pair<int, int> > cgi_pool;
   std::pair<int, std::string> redirect;
   std::map<std::string, ServerLocation> location;
   int autoindex;
+  int sendfile;
+  int gzip_static;
+  int brotli_static;
+  int gzip;
+  std::vector<std::string> gzip_types;
+  int gzip_min_length;
+  int gzip_comp_level;
+  std::string expires;
+  std::vector<std::string> add_header;
   int sockfd;
   int upload;
   std::string upload_store;
@@ -63,9 +78,9 @@ class Server {
   void fill(void);
   bool is_invalid(void);
   void _socket(void);
-  void _bind(void);
+  void _bind(bool reuseport);
   void _listen(int backlog);
-  int _connect(int backlog);
+  int _connect(int backlog, bool reuseport = false);
   void print(void);
   static void print_addr(std::pair<const int, Server*>& p);
 
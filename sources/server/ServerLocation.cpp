@@ -7,12 +7,53 @@
 
 #include "ServerLocation.hpp"
 
+// the seconds of an expires time such as 30d or -1h
+static long expires_seconds(const std::string& expires) {
+  size_t start = (expires[0] == '-') ? 1 : 0;
+  size_t end = expires.find_first_not_of("0123456789", start);
+  long seconds = String::to_int(expires.substr(start, end - start));
+  if (end != std::string::npos) {
+    std::string units("smhdw");
+    long scale[] = {1, 60, 3600, 86400, 604800};
+    seconds *= scale[units.find(expires[end])];
+  }
+  return (start ? -seconds : seconds);
+}
+
+// the Cache-Control (and Expires) lines for a value of the expires directive.
+// The Expires date of a time depends on the response, Response adds it
+static std::string expires_header(const std::string& expires) {
+  if (expires.empty() || expires == "off")
+    return ("");
+  if (expires == "epoch")
+    return ("Expires: Thu, 01 Jan 1970 00:00:01 GMT\n"
+            "Cache-Control: no-cache\n");
+  if (expires == "max")
+    return ("Expires: Thu, 31 Dec 2037 23:55:55 GMT\n"
+            "Cache-Control: max-age=315360000\n");
+  long seconds = expires_seconds(expires);
+  if (seconds < 0)
+    return ("Cache-Control: no-cache\n");
+  std::stringstream ss;
+  ss << "Cache-Control: max-age=" << seconds << "\n";
+  return (ss.str());
+}
+
 ServerLocation::ServerLocation(void) {
   root = "";
   client_max_body_size = -1;
+  client_body_buffer_size = -1;
   autoindex = -1;
+  sendfile = -1;
+  gzip_static = -1;
+  brotli_static = -1;
+  gzip = -1;
+  gzip_min_length = -1;
+  gzip_comp_level = -1;
   upload = -1;
   upload_store = "";
+  expires_relative = false;
+  expires_in = 0;
 }
 
 ServerLocation::ServerLocation(const ServerLocation& src) {
@@ -29,15 +70,51 @@ ServerLocation& ServerLocation::operator=(const ServerLocation& rhs) {
     index = rhs.index;
     limit_except = rhs.limit_except;
     client_max_body_size = rhs.client_max_body_size;
+    client_body_buffer_size = rhs.client_body_buffer_size;
     cgi = rhs.cgi;
+    fastcgi_pass = rhs.fastcgi_pass;
     redirect = rhs.redirect;
     autoindex = rhs.autoindex;
+    sendfile = rhs.sendfile;
+    gzip_static = rhs.gzip_static;
+    brotli_static = rhs.brotli_static;
+    gzip = rhs.gzip;
+    gzip_types = rhs.gzip_types;
+    gzip_min_length = rhs.gzip_min_length;
+    gzip_comp_level = rhs.gzip_comp_level;
+    expires = rhs.expires;
+    add_header = rhs.add_header;
     upload = rhs.upload;
     upload_store = rhs.upload_store;
+    headers = rhs.headers;
+    expires_relative = rhs.expires_relative;
+    expires_in = rhs.expires_in;
+    cgi_env = rhs.cgi_env;
   }
   return (*this);
 }
 
+// the part of the CGI environment that is the same for every request
+static std::map<std::string, std::string> static_environment(
+    const Server& srv) {
+  std::map<std::string, std::string> env;
+  std::stringstream port;
+  in_addr addr;
+
+  addr.s_addr = srv.ip;
+  port << ntohs(srv.port);
+  env["SERVER_NAME"] = (srv.server_name.size() ? srv.server_name[0] : "") +
+                       " | " + inet_ntoa(addr);
+  env["SERVER_PORT"] = port.str();
+  env["SERVER_SOFTWARE"] = "TDD/4.0";
+  env["SERVER_PROTOCOL"] = "HTTP/1.1";
+  env["GATEWAY_INTERFACE"] = "CGI/1.1";
+  env["REDIRECT_STATUS"] = "200";
+  if (std::getenv("PATH"))
+    env["PATH"] = std::getenv("PATH");
+  return (env);
+}
+
 void ServerLocation::fill(const Server& srv) {
   if (root.empty())
     root = srv.root;
@@ -47,14 +124,44 @@ void ServerLocation::fill(const Server& srv) {
     limit_except.push_back(DFL_LIM_EXCEPT);
   if (client_max_body_size == -1)
     client_max_body_size = srv.client_max_body_size;
+  if (client_body_buffer_size == -1)
+    client_body_buffer_size = srv.client_body_buffer_size;
   if (cgi.size() == 0)
     cgi = srv.cgi;
+  if (fastcgi_pass.size() == 0)
+    fastcgi_pass = srv.fastcgi_pass;
   if (redirect.first == 0 && redirect.second == "")
     redirect = srv.redirect;
   if (autoindex == -1)
     autoindex = srv.autoindex;
+  if (sendfile == -1)
+    sendfile = srv.sendfile;
+  if (gzip_static == -1)
+    gzip_static = srv.gzip_static;
+  if (brotli_static == -1)
+    brotli_static = srv.brotli_static;
+  if (gzip == -1)
+    gzip = srv.gzip;
+  if (gzip_types.size() == 0)
+    gzip_types = srv.gzip_types;
+  if (gzip_min_length == -1)
+    gzip_min_length = srv.gzip_min_length;
+  if (gzip_comp_level == -1)
+    gzip_comp_level = srv.gzip_comp_level;
+  if (expires.empty())
+    expires = srv.expires;
+  if (add_header.size() == 0)
+    add_header = srv.add_header;
   if (upload == -1)
     upload = DFL_UPLOAD;
   if (upload_store.empty())
     upload_store = DFL_UPLOAD_STORE;
+  headers = expires_header(expires);
+  expires_relative = !expires.empty() && expires != "off" &&
+                     expires != "epoch" && expires != "max";
+  if (expires_relative)
+    expires_in = expires_seconds(expires);
+  for (size_t i = 0; i < add_header.size(); i++)
+    headers.append(add_header[i]);
+  cgi_env = static_environment(srv);
 }
@@ -9,6 +9,7 @@
 #ifndef SERVERLOCATION_HPP
 #define SERVERLOCATION_HPP
 
+#include <cstdlib>
 #include <map>
 #include <string>
 #include <utility>
@@ -26,11 +27,29 @@ class ServerLocation {
   std::vector<std::string> index;
   std::vector<std::string> limit_except;
   int client_max_body_size;
+  int client_body_buffer_size;
   std::map<std::string, std::string> cgi;
+  std::map<std::string, std::string> fastcgi_pass;
   std::pair<int, std::string> redirect;
   int autoindex;
+  int sendfile;
+  int gzip_static;
+  int brotli_static;
+  int gzip;
+  std::vector<std::string> gzip_types;
+  int gzip_min_length;
+  int gzip_comp_level;
+  std::string expires;
+  std::vector<std::string> add_header;
   int upload;
   std::string upload_store;
+  // expires and add_header rendered once, appended to responses as is
+  std::string headers;
+  // expires with a time: the Expires date is that far from each response
+  bool expires_relative;
+  long expires_in;
+  // the CGI variables that do not depend on the request
+  std::map<std::string, std::string> cgi_env;
 
   ServerLocation(void);
   ServerLocation(const ServerLocation& src);
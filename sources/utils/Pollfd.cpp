@@ -10,3 +10,5 @@
 _pollfd::_pollfd(void): fd(0), events(0), revents(0) { }
 _pollfd::_pollfd(int _fd): fd(_fd), events(0), revents(0) { }
 _pollfd::_pollfd(int _fd, short int _ev): fd(_fd), events(_ev), revents(0) { }
+_pollfd::_pollfd(int _fd, short int _ev, short int _rev)
+: fd(_fd), events(_ev), revents(_rev) { }
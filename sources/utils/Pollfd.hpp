@@ -13,6 +13,7 @@ public:
   _pollfd();
   _pollfd(int _fd);
   _pollfd(int _fd, short int _events);
+  _pollfd(int _fd, short int _events, short int _revents);
 
   int       fd;
   short int events;
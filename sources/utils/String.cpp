@@ -7,6 +7,8 @@
 
 #include "String.hpp"
 
+#include <cctype>
+
 namespace String {
 
 void replace_all(std::string* str, std::string old_word, std::string new_word) {
@@ -83,4 +85,12 @@ int to_int(const std::string& str) {
   return (n);
 }
 
+std::string to_lower(const std::string& str) {
+  std::string tmp(str);
+
+  for (size_t i = 0; i < tmp.size(); i++)
+    tmp[i] = std::tolower(static_cast<unsigned char>(tmp[i]));
+  return (tmp);
+}
+
 }  // namespace String
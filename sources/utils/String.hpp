@@ -21,6 +21,7 @@ std::string trim_last_if(const std::string& str, char c);
 void trim_lines(std::string* str, const std::string& set);
 std::vector<std::string> split(const std::string& str, const std::string& del);
 int to_int(const std::string& str);
+std::string to_lower(const std::string& str);
 
 }  // namespace String
 
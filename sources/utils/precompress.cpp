@@ -0,0 +1,152 @@
+//##############################################################################
+//#              Copyright(c)2022 Turbo Development Design (TDD)               #
+//#                         João Rodriguez - VLN37                             #
+//#                         Paulo Sergio - psergio-                            #
+//#                         Welton Leite - wleite                              #
+//##############################################################################
+
+#include "precompress.hpp"
+
+#include <brotli/encode.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "WebServ.hpp"
+
+static bool gzip(const std::string& in, std::string* out) {
+  z_stream zs;
+
+  std::memset(&zs, 0, sizeof(zs));
+  // 16 added to the window bits asks zlib for a gzip wrapper
+  if (deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9,
+                   Z_DEFAULT_STRATEGY) != Z_OK)
+    return (false);
+  out->resize(deflateBound(&zs, in.size()));
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  zs.avail_in = in.size();
+  zs.next_out = reinterpret_cast<Bytef*>(&(*out)[0]);
+  zs.avail_out = out->size();
+  int ret = deflate(&zs, Z_FINISH);
+  out->resize(zs.total_out);
+  deflateEnd(&zs);
+  return (ret == Z_STREAM_END);
+}
+
+static bool brotli(const std::string& in, std::string* out) {
+  size_t size = BrotliEncoderMaxCompressedSize(in.size());
+
+  if (size == 0)
+    return (false);
+  out->resize(size);
+  if (!BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW,
+                             BROTLI_MODE_TEXT, in.size(),
+                             reinterpret_cast<const uint8_t*>(in.data()),
+                             &size, reinterpret_cast<uint8_t*>(&(*out)[0])))
+    return (false);
+  out->resize(size);
+  return (true);
+}
+
+static bool compressible(const std::string& path) {
+  std::vector<std::string> types = String::split(DFL_PRECOMPRESS_TYPES, " ");
+  size_t dot = path.find_last_of('.');
+
+  if (dot == std::string::npos || path.find('/', dot) != std::string::npos)
+    return (false);
+  return (std::find(types.begin(), types.end(), path.substr(dot)) !=
+          types.end());
+}
+
+// a sidecar is only rewritten when the asset changed after it was made, and
+// only kept when it is actually smaller
+static int write_sidecar(const std::string& path, const struct stat& src,
+                         const std::string& content, const char* suffix,
+                         bool (*compress)(const std::string&, std::string*)) {
+  std::string sidecar(path + suffix);
+  std::string packed;
+  struct stat st;
+
+  if (stat(sidecar.c_str(), &st) == 0 && st.st_mtime >= src.st_mtime)
+    return (0);
+  if (!compress(content, &packed)) {
+    WebServ::log.error() << "precompress: failed to compress " << path << "\n";
+    return (1);
+  }
+  // an older sidecar would outlive the asset it was made from
+  if (packed.size() >= content.size()) {
+    if (unlink(sidecar.c_str()) != 0 && errno != ENOENT) {
+      WebServ::log.error() << "precompress: " << sidecar << ": "
+                           << strerror(errno) << "\n";
+      return (1);
+    }
+    return (0);
+  }
+  std::ofstream ofs(sidecar.c_str(), std::ios::binary | std::ios::trunc);
+  ofs.write(packed.data(), packed.size());
+  if (!ofs) {
+    WebServ::log.error() << "precompress: " << sidecar << ": "
+                         << strerror(errno) << "\n";
+    return (1);
+  }
+  WebServ::log.info() << sidecar << " " << content.size() << " -> "
+                      << packed.size() << "\n";
+  return (0);
+}
+
+static int precompress_file(const std::string& path, const struct stat& st) {
+  std::ifstream ifs(path.c_str(), std::ios::binary);
+  std::ostringstream content;
+  int errors = 0;
+
+  content << ifs.rdbuf();
+  if (!ifs) {
+    WebServ::log.error() << "precompress: " << path << ": "
+                         << strerror(errno) << "\n";
+    return (1);
+  }
+  errors += write_sidecar(path, st, content.str(), ".gz", gzip);
+  errors += write_sidecar(path, st, content.str(), ".br", brotli);
+  return (errors);
+}
+
+static int precompress_dir(const std::string& dir) {
+  DIR* dp = opendir(dir.c_str());
+  struct dirent* entry;
+  struct stat st;
+  int errors = 0;
+
+  if (dp == NULL) {
+    WebServ::log.error() << "precompress: " << dir << ": "
+                         << strerror(errno) << "\n";
+    return (1);
+  }
+  while ((entry = readdir(dp)) != NULL) {
+    std::string name(entry->d_name);
+    if (name == "." || name == "..")
+      continue;
+    std::string path(dir + "/" + name);
+    if (lstat(path.c_str(), &st) == -1)
+      continue;
+    if (S_ISDIR(st.st_mode))
+      errors += precompress_dir(path);
+    else if (S_ISREG(st.st_mode) && compressible(path))
+      errors += precompress_file(path, st);
+  }
+  closedir(dp);
+  return (errors);
+}
+
+int precompress(const std::string& root) {
+  std::string dir(String::trim_last_if(root, '/'));
+
+  return (precompress_dir(dir) ? 1 : 0);
+}
@@ -5,17 +5,14 @@
 //#                         Welton Leite - wleite                              #
 //##############################################################################
 
-#ifndef HTTPBASE_HPP
-#define HTTPBASE_HPP
+#pragma once
+#ifndef PRECOMPRESS_HPP
+#define PRECOMPRESS_HPP
 
-#define BUFFER_SIZE 100000
-#define HEADER_SIZE 5000
+#include <string>
 
-class ResponseBase {
- public:
-  static char buffer_req[BUFFER_SIZE];
-  static char buffer_resp[HEADER_SIZE + BUFFER_SIZE];
-  static int size;
-};
+// webserv --precompress <root>: writes the .gz and .br files served by
+// gzip_static and brotli_static next to every text asset found under root
+int precompress(const std::string& root);
 
-#endif  // HTTPBASE_HPP
+#endif  // PRECOMPRESS_HPP
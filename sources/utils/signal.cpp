@@ -7,6 +7,10 @@
 
 #include "signal.hpp"
 
+volatile sig_atomic_t master_signal = 0;
+static int child_pipe[2] = {-1, -1};
+static std::set<pid_t> children;
+
 void sighandler(const int signal, void *ptr) {
   static WebServ *webserv = NULL;
   if (webserv == NULL)
@@ -22,5 +26,67 @@ void init_signals(WebServ *ptr) {
   func = reinterpret_cast<void *>(sighandler);
   std::signal(SIGINT, reinterpret_cast<__sighandler_t>(func));
   std::signal(SIGQUIT, reinterpret_cast<__sighandler_t>(func));
+  // responses go out through writev(), which has no MSG_NOSIGNAL
+  std::signal(SIGPIPE, SIG_IGN);
   sighandler(0, ptr);
 }
+
+static void master_sighandler(int signal) {
+  master_signal = signal;
+}
+
+// no SA_RESTART, the master must be woken up from waitpid()
+void init_master_signals(void) {
+  struct sigaction sa;
+
+  std::memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = master_sighandler;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGQUIT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+}
+
+static void child_sighandler(int signal) {
+  int saved = errno;
+
+  (void)signal;
+  write(child_pipe[1], "", 1);
+  errno = saved;
+}
+
+// CGI children are reaped from the event loop, the handler only wakes it up
+// through a self-pipe whose read end is returned
+int init_child_signal(void) {
+  struct sigaction sa;
+
+  if (child_pipe[0] == -1 && pipe2(child_pipe, O_NONBLOCK | O_CLOEXEC) == -1)
+    return (-1);
+  std::memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = child_sighandler;
+  sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGCHLD, &sa, NULL);
+  return (child_pipe[0]);
+}
+
+// CGI children are only signalled while unreaped, once waited for their pid
+// may already belong to another process
+void track_child(pid_t pid) {
+  children.insert(pid);
+}
+
+void kill_child(pid_t pid) {
+  if (children.count(pid))
+    kill(pid, SIGKILL);
+}
+
+void reap_children(void) {
+  char buf[64];
+  pid_t pid;
+
+  while (read(child_pipe[0], buf, sizeof(buf)) > 0)
+    continue;
+  while ((pid = waitpid(-1, NULL, WNOHANG)) > 0)
+    children.erase(pid);
+}
@@ -9,7 +9,13 @@
 #ifndef SIGNAL_HPP
 #define SIGNAL_HPP
 
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
 #include <cstdlib>
+#include <cstring>
 #include <set>
 #include <string>
 #include <vector>
@@ -20,7 +26,14 @@
 class WebServ;
 class Config;
 
+extern volatile sig_atomic_t master_signal;
+
 void sighandler(const int signal, void* ptr);
 void init_signals(WebServ* ptr);
+void init_master_signals(void);
+int init_child_signal(void);
+void track_child(pid_t pid);
+void kill_child(pid_t pid);
+void reap_children(void);
 
 #endif  // SIGNAL_HPP